@@ -0,0 +1,579 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "engine/game.h"
+#include "engine/renderer.h"
+#include "reference.h"
+
+/*
+ * Microbenchmarks for the engine's kernels. Every kernel runs in isolation
+ * on seeded random levels and camera poses, once as the reference scalar
+ * code and once as the engine's current code. The results of both are
+ * compared, and the timings and mismatches are written as JSON.
+ *
+ * Usage: raycaster_bench [--seed N] [--iterations N] [--json FILE]
+ * Run from the root of the repository, so the textures can be found.
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DECLARATIONS
+///////////////////////////////////////////////////////////////////////////////
+
+// Distances may differ by this much, relative to their size.
+const double TOLERANCE = 1e-9;
+
+struct Ray
+{
+    double px;
+    double py;
+    double theta;
+    double tangent;
+};
+
+struct Scenario
+{
+    Engine::Level level;
+    std::vector<Engine::Camera> cameras;
+    std::vector<Ray> rays;
+};
+
+struct KernelResult
+{
+    std::string name;
+    long operations = 0;
+    double reference_ns = 0;  // Per operation
+    double optimized_ns = 0;
+    long checked = 0;
+    long excluded = 0;  // Rays that leave the level and wrap in the reference, see reference.h
+    long mismatches = 0;
+    double max_error = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// HELPERS
+///////////////////////////////////////////////////////////////////////////////
+
+// Keeps results alive, so the compiler can't drop the work that produced them.
+volatile double sink;
+
+template <typename F>
+double nanoseconds_per_operation(long operations, int iterations, F&& run)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) run();
+    const std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / (operations * iterations);
+}
+
+bool distances_match(double a, double b, double& max_error)
+{
+    if (std::isinf(a) || std::isinf(b)) return a == b;
+
+    const double error = std::abs(a - b) / std::max(1.0, std::abs(a));
+    max_error = std::max(max_error, error);
+
+    return error <= TOLERANCE;
+}
+
+// Whether (x, y) lies outside the level, by the same cell rounding the hit functions use.
+bool outside(const Engine::Level& level, double x, double y)
+{
+    const int cx = static_cast<int>(x) >> 6;
+    const int cy = static_cast<int>(y) >> 6;
+
+    return cx < 0 || cx >= level.width || cy < 0 || cy >= level.height;
+}
+
+/*
+ * The distance at which a hit search of the reference finds a wall after
+ * leaving the level and wrapping into another row, or INFINITY when the
+ * search doesn't wrap. The engine stops at the edge of the level instead.
+ */
+template <typename Reference, typename Optimized>
+double wrapped_hit(const Engine::Level& level, const Ray& r, Reference reference,
+                   Optimized optimized, double& distance)
+{
+    double x, y;
+    int t;
+
+    const double a = reference(level, r.px, r.py, r.theta, r.tangent, x, y, t);
+    distance = optimized(level, r.px, r.py, r.theta, r.tangent, x, y, t);
+
+    return (std::isinf(distance) && outside(level, x, y)) ? a : INFINITY;
+}
+
+// Whether a wrapped hit is nearer than the real wall, so the reference draws another column.
+bool wraps(const Engine::Level& level, const Ray& r)
+{
+    double v, h;
+    const double wrapped_v = wrapped_hit(level, r, Reference::calculate_vertical_hits,
+                                         Engine::calculate_vertical_hits, v);
+    const double wrapped_h = wrapped_hit(level, r, Reference::calculate_horizontal_hits,
+                                         Engine::calculate_horizontal_hits, h);
+
+    return std::min(wrapped_v, wrapped_h) <= std::min(v, h);
+}
+
+// Whether column ray of a and b has the same pixels and depth.
+bool columns_match(const Engine::FrameBuffer& a, const Engine::FrameBuffer& b, int ray)
+{
+    if (a.depth[ray] != b.depth[ray]) return false;
+
+    for (int y = 0; y < Engine::RENDER_HEIGHT; ++y)
+    {
+        const int i = (y * Engine::RENDER_WIDTH + ray) * 3;
+        if (std::memcmp(&a.pixels[i], &b.pixels[i], 3) != 0) return false;
+    }
+
+    return true;
+}
+
+/*
+ * A level of size by size cells with solid borders and random walls inside,
+ * with cameras placed in empty cells and the rays they cast for one frame.
+ */
+Scenario make_scenario(std::mt19937& rng, int size, int cameras, int textures)
+{
+    std::bernoulli_distribution wall(0.2);
+    std::uniform_int_distribution<int> texture(1, textures);
+
+    std::vector<int> cells(size * size);
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            const bool border = x == 0 || y == 0 || x == size - 1 || y == size - 1;
+            cells[y * size + x] = (border || wall(rng)) ? texture(rng) : 0;
+        }
+    }
+
+    Scenario scenario{Engine::Level{size, size, cells}, {}, {}};
+
+    std::uniform_real_distribution<double> position(64, (size - 1) * 64);
+    std::uniform_real_distribution<double> angle(0, 360);
+
+    while (static_cast<int>(scenario.cameras.size()) < cameras)
+    {
+        const double x = position(rng);
+        const double y = position(rng);
+
+        if (scenario.level[(static_cast<int>(y) >> 6) * size + (static_cast<int>(x) >> 6)] == 0)
+            scenario.cameras.push_back({x, y, angle(rng)});
+    }
+
+    for (const Engine::Camera& camera : scenario.cameras)
+    {
+        double r_angle = Engine::clamp_to_unit_circle(camera.angle + 30);
+
+        for (int ray = 0; ray < Engine::RENDER_WIDTH; ++ray)
+        {
+            const double theta = Engine::degrees_to_radians(r_angle);
+            scenario.rays.push_back({camera.x, camera.y, theta, tan(theta)});
+
+            r_angle = Engine::clamp_to_unit_circle(r_angle - 60.0 / Engine::RENDER_WIDTH);
+        }
+    }
+
+    return scenario;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// KERNELS
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename Reference, typename Optimized>
+KernelResult bench_hits(const std::string& name, const Scenario& scenario, int iterations,
+                        Reference reference, Optimized optimized)
+{
+    KernelResult result{name, static_cast<long>(scenario.rays.size())};
+    const Engine::Level& level = scenario.level;
+
+    for (const Ray& r : scenario.rays)
+    {
+        double ax, ay, bx, by;
+        int at = -1, bt = -1;
+
+        const double a = reference(level, r.px, r.py, r.theta, r.tangent, ax, ay, at);
+        const double b = optimized(level, r.px, r.py, r.theta, r.tangent, bx, by, bt);
+
+        if (std::isinf(b) && outside(level, bx, by) && !std::isinf(a))
+        {
+            result.excluded++;
+            continue;
+        }
+
+        result.checked++;
+        if (!distances_match(a, b, result.max_error) || (!std::isinf(a) && at != bt))
+            result.mismatches++;
+    }
+
+    auto run = [&](auto kernel)
+    {
+        double total = 0, x, y;
+        int t;
+
+        for (const Ray& r : scenario.rays)
+            total += kernel(level, r.px, r.py, r.theta, r.tangent, x, y, t);
+        sink = total;
+    };
+
+    result.reference_ns = nanoseconds_per_operation(result.operations, iterations,
+                                                    [&]() { run(reference); });
+    result.optimized_ns = nanoseconds_per_operation(result.operations, iterations,
+                                                    [&]() { run(optimized); });
+
+    return result;
+}
+
+// Draws one frame of random wall columns: every height up to the scaler limit and beyond.
+KernelResult bench_wall_column(std::mt19937& rng, const Engine::TextureTable& textures,
+                               int iterations)
+{
+    struct Column
+    {
+        int height;
+        int tx;
+        int texture;
+    };
+
+    std::uniform_int_distribution<int> height(1, Engine::MAX_SCALED_HEIGHT + 512);
+    std::uniform_int_distribution<int> tx(0, 63);
+    std::uniform_int_distribution<int> texture(0, textures.size() - 1);
+
+    std::vector<Column> columns(Engine::RENDER_WIDTH);
+    for (Column& column : columns) column = {height(rng), tx(rng), texture(rng)};
+
+    Engine::FrameBuffer a, b;
+    KernelResult result{"wall_column", static_cast<long>(columns.size())};
+
+    auto run_reference = [&]()
+    {
+        for (int ray = 0; ray < Engine::RENDER_WIDTH; ++ray)
+        {
+            const Column& c = columns[ray];
+            Reference::fill_wall_column(*textures[c.texture], a.pixels, ray, c.height, c.tx);
+        }
+    };
+
+    auto run_optimized = [&]()
+    {
+        for (int ray = 0; ray < Engine::RENDER_WIDTH; ++ray)
+        {
+            const Column& c = columns[ray];
+            Engine::draw_wall_column(b.pixels, ray, c.height, textures[c.texture]->column(c.tx));
+        }
+    };
+
+    run_reference();
+    run_optimized();
+
+    for (int ray = 0; ray < Engine::RENDER_WIDTH; ++ray)
+    {
+        bool same = true;
+        for (int y = 0; y < Engine::RENDER_HEIGHT; ++y)
+        {
+            const int pixel = (y * Engine::RENDER_WIDTH + ray) * 3;
+            same = same && std::memcmp(&a.pixels[pixel], &b.pixels[pixel], 3) == 0;
+        }
+
+        result.checked++;
+        if (!same) result.mismatches++;
+    }
+
+    result.reference_ns = nanoseconds_per_operation(result.operations, iterations, run_reference);
+    result.optimized_ns = nanoseconds_per_operation(result.operations, iterations, run_optimized);
+
+    return result;
+}
+
+KernelResult bench_sprite_projection(std::mt19937& rng, const Scenario& scenario, int iterations)
+{
+    struct Sprite
+    {
+        double x;
+        double y;
+        double z;
+    };
+
+    const double extent = scenario.level.width * 64.0;
+    std::uniform_real_distribution<double> position(0, extent);
+    std::uniform_real_distribution<double> height(0, 32);
+
+    std::vector<Sprite> sprites(64);
+    for (Sprite& sprite : sprites) sprite = {position(rng), position(rng), height(rng)};
+
+    KernelResult result{"sprite_projection",
+                        static_cast<long>(sprites.size() * scenario.cameras.size())};
+
+    for (const Engine::Camera& camera : scenario.cameras)
+    {
+        const double theta = Engine::degrees_to_radians(camera.angle);
+
+        for (const Sprite& s : sprites)
+        {
+            const auto a = Reference::project_sprite(camera, s.x, s.y, s.z);
+            const auto b =
+                Engine::project_sprite(camera, cos(theta), sin(theta), s.x, s.y, s.z);
+
+            const bool same = distances_match(a.sx, b.sx, result.max_error) &&
+                              distances_match(a.sy, b.sy, result.max_error) &&
+                              distances_match(a.depth, b.depth, result.max_error) &&
+                              a.scale == b.scale;
+
+            result.checked++;
+            if (!same) result.mismatches++;
+        }
+    }
+
+    result.reference_ns = nanoseconds_per_operation(
+        result.operations, iterations,
+        [&]()
+        {
+            double total = 0;
+            for (const Engine::Camera& camera : scenario.cameras)
+                for (const Sprite& s : sprites)
+                    total += Reference::project_sprite(camera, s.x, s.y, s.z).sx;
+            sink = total;
+        });
+
+    result.optimized_ns = nanoseconds_per_operation(
+        result.operations, iterations,
+        [&]()
+        {
+            double total = 0;
+            for (const Engine::Camera& camera : scenario.cameras)
+            {
+                const double theta = Engine::degrees_to_radians(camera.angle);
+                const double cos_theta = cos(theta), sin_theta = sin(theta);
+
+                for (const Sprite& s : sprites)
+                    total += Engine::project_sprite(camera, cos_theta, sin_theta, s.x, s.y, s.z).sx;
+            }
+            sink = total;
+        });
+
+    return result;
+}
+
+// Compares whole views column by column, leaving out the columns of rays that wrap.
+KernelResult bench_render_view(const std::string& name, const Scenario& scenario,
+                               const Engine::TextureTable& textures, int iterations,
+                               const Engine::Lightmap* lightmap = nullptr)
+{
+    KernelResult result{name, static_cast<long>(scenario.cameras.size())};
+    Engine::FrameBuffer a, b;
+
+    for (size_t i = 0; i < scenario.cameras.size(); ++i)
+    {
+        const Engine::Camera& camera = scenario.cameras[i];
+
+        Reference::render_view(scenario.level, textures, camera, a.pixels, a.depth, lightmap);
+        Engine::render_view(scenario.level, textures, camera, b.pixels, b.depth, lightmap);
+
+        bool same = true;
+        for (int ray = 0; ray < Engine::RENDER_WIDTH; ++ray)
+        {
+            if (wraps(scenario.level, scenario.rays[i * Engine::RENDER_WIDTH + ray]))
+                result.excluded++;
+            else
+                same = same && columns_match(a, b, ray);
+        }
+
+        result.checked++;
+        if (!same) result.mismatches++;
+    }
+
+    result.reference_ns = nanoseconds_per_operation(
+        result.operations, iterations,
+        [&]()
+        {
+            for (const Engine::Camera& camera : scenario.cameras)
+                Reference::render_view(scenario.level, textures, camera, a.pixels, a.depth,
+                                       lightmap);
+        });
+
+    result.optimized_ns = nanoseconds_per_operation(
+        result.operations, iterations,
+        [&]()
+        {
+            for (const Engine::Camera& camera : scenario.cameras)
+                Engine::render_view(scenario.level, textures, camera, b.pixels, b.depth,
+                                    lightmap);
+        });
+
+    return result;
+}
+
+KernelResult bench_texture_load(const std::vector<std::string>& names, int iterations)
+{
+    KernelResult result{"texture_load", static_cast<long>(names.size())};
+
+    for (const std::string& name : names)
+    {
+        std::vector<uint32_t> texels;
+        Engine::Texture texture;
+
+        const bool a = Reference::load_texture(name, texels);
+        const bool b = texture.load(name);
+
+        bool same = a == b;
+        for (int i = 0; same && a && i < 64 * 64; ++i)
+        {
+            const uint8_t* texel = texture.column(i % 64) + (i / 64) * 3;
+            const uint32_t column = (texel[0] << 16) | (texel[1] << 8) | texel[2];
+
+            same = texels[i] == texture[i] && texels[i] == column;
+        }
+
+        // Every shaded copy holds each channel scaled by its light level.
+        for (int level = 0; same && a && level < Engine::LIGHT_LEVELS; ++level)
+        {
+            for (int i = 0; same && i < 64 * 64; ++i)
+            {
+                const uint8_t* texel = texture.column(i % 64, level) + (i / 64) * 3;
+
+                for (int channel = 0; channel < 3; ++channel)
+                {
+                    const int value = (texels[i] >> (16 - 8 * channel)) & 0xFF;
+                    same = same && texel[channel] ==
+                                       std::min(255, value * level / Engine::FULL_BRIGHT);
+                }
+            }
+        }
+
+        result.checked++;
+        if (!same) result.mismatches++;
+    }
+
+    result.reference_ns = nanoseconds_per_operation(result.operations, iterations,
+                                                    [&]()
+                                                    {
+                                                        std::vector<uint32_t> texels;
+                                                        for (const auto& name : names)
+                                                            Reference::load_texture(name, texels);
+                                                    });
+
+    result.optimized_ns = nanoseconds_per_operation(result.operations, iterations,
+                                                    [&]()
+                                                    {
+                                                        for (const auto& name : names)
+                                                        {
+                                                            Engine::Texture texture;
+                                                            texture.load(name);
+                                                        }
+                                                    });
+
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// REPORT
+///////////////////////////////////////////////////////////////////////////////
+
+std::string to_json(unsigned int seed, int iterations, const std::vector<KernelResult>& results)
+{
+    std::ostringstream json;
+    json << "{\n  \"seed\": " << seed << ",\n  \"iterations\": " << iterations
+         << ",\n  \"kernels\": [\n";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const KernelResult& r = results[i];
+
+        json << "    {\"name\": \"" << r.name << "\", \"operations\": " << r.operations
+             << ", \"reference_ns\": " << r.reference_ns << ", \"optimized_ns\": " << r.optimized_ns
+             << ", \"speedup\": " << r.reference_ns / r.optimized_ns
+             << ", \"checked\": " << r.checked << ", \"excluded\": " << r.excluded
+             << ", \"mismatches\": " << r.mismatches
+             << ", \"max_error\": " << r.max_error << "}"
+             << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+
+    json << "  ]\n}\n";
+
+    return json.str();
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int seed = 1;
+    int iterations = 20;
+    const char* json_path = nullptr;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--seed") == 0)
+            seed = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--iterations") == 0)
+            iterations = std::max(1, std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--json") == 0)
+            json_path = argv[i + 1];
+    }
+
+    const std::vector<std::string> names = {"wood.ppm", "eagle.ppm", "skull.ppm"};
+
+    Engine::TextureTable textures;
+    for (const std::string& name : names)
+        textures.push_back(std::make_shared<Engine::Texture>(name));
+
+    std::mt19937 rng(seed);
+    std::vector<KernelResult> results;
+
+    for (int size : {12, 32, 64})
+    {
+        const Scenario scenario = make_scenario(rng, size, 16, textures.size());
+        const std::string suffix = "/" + std::to_string(size);
+
+        results.push_back(bench_hits("calculate_vertical_hits" + suffix, scenario, iterations,
+                                     Reference::calculate_vertical_hits,
+                                     Engine::calculate_vertical_hits));
+        results.push_back(bench_hits("calculate_horizontal_hits" + suffix, scenario, iterations,
+                                     Reference::calculate_horizontal_hits,
+                                     Engine::calculate_horizontal_hits));
+        results.push_back(bench_sprite_projection(rng, scenario, iterations));
+        results.back().name += suffix;
+        results.push_back(bench_render_view("render_view" + suffix, scenario, textures,
+                                            iterations));
+
+        // Lit by static lights and one dynamic light, anywhere in the level.
+        Engine::Level lit = scenario.level;
+        std::uniform_real_distribution<double> position(64, (size - 1) * 64);
+        for (int i = 0; i < size / 4; ++i)
+            lit.lights.push_back({position(rng), position(rng), 5 * 64, 0.8});
+
+        Engine::Lightmap lightmap;
+        lightmap.bake(lit);
+        lightmap.add_light(lit, {position(rng), position(rng), 4 * 64, 1.5});
+
+        results.push_back(bench_render_view("render_view_lit" + suffix, scenario, textures,
+                                            iterations, &lightmap));
+    }
+
+    results.push_back(bench_wall_column(rng, textures, iterations));
+    results.push_back(bench_texture_load(names, iterations));
+
+    const std::string json = to_json(seed, iterations, results);
+
+    if (json_path)
+        std::ofstream(json_path) << json;
+    else
+        std::cout << json;
+
+    long mismatches = 0;
+    for (const KernelResult& r : results) mismatches += r.mismatches;
+
+    if (mismatches > 0)
+        std::cerr << mismatches << " results differ from the reference" << std::endl;
+
+    return mismatches > 0 ? 1 : 0;
+}
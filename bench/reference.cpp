@@ -0,0 +1,276 @@
+#include "reference.h"
+
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#include "engine/game.h"
+
+namespace Reference
+{
+using namespace Engine;
+
+double calculate_vertical_hits(const Level& level, double px, double py, double theta,
+                               double tangent, double& vx, double& vy, int& vmt)
+{
+    double d_vertical = INFINITY;
+    double ox, oy;
+
+    if (cos(theta) > EPSILON)  // Points left
+    {
+        vx = ((static_cast<int>(px) >> 6) << 6) + 64;
+        vy = (px - vx) * tangent + py;
+
+        ox = 64;
+        oy = -64 * tangent;
+    }
+    else if (cos(theta) < -EPSILON)  // Points right
+    {
+        vx = ((static_cast<int>(px) >> 6) << 6) - EPSILON;
+        vy = (px - vx) * tangent + py;
+
+        ox = -64;
+        oy = 64 * tangent;
+    }
+    else  // Points straight up or down, no hit
+    {
+        vx = px;
+        vy = py;
+
+        return d_vertical;
+    }
+
+    for (int depth = 0; depth <= level.width; ++depth)
+    {
+        int pos = (static_cast<int>(vy) >> 6) * level.width + (static_cast<int>(vx) >> 6);
+        bool hit = pos > 0 && pos < level.width * level.height && level[pos] > 0;
+        if (hit)
+        {
+            vmt = level[pos] - 1;
+            d_vertical = cos(theta) * (vx - px) - sin(theta) * (vy - py);
+
+            break;
+        }
+
+        vx += ox;
+        vy += oy;
+    }
+
+    return d_vertical;
+}
+
+double calculate_horizontal_hits(const Level& level, double px, double py, double theta,
+                                 double tangent, double& hx, double& hy, int& hmt)
+{
+    tangent = 1.0 / tangent;
+
+    double d_horizontal = INFINITY;
+    double ox, oy;
+
+    if (sin(theta) > EPSILON)  // Points up
+    {
+        hy = ((static_cast<int>(py) >> 6) << 6) - EPSILON;
+        hx = (py - hy) * tangent + px;
+
+        ox = 64 * tangent;
+        oy = -64;
+    }
+    else if (sin(theta) < -EPSILON)  // Points down
+    {
+        hy = ((static_cast<int>(py) >> 6) << 6) + 64;
+        hx = (py - hy) * tangent + px;
+
+        ox = -64 * tangent;
+        oy = 64;
+    }
+    else  // Points straight left or right, no hit
+    {
+        hx = px;
+        hy = py;
+
+        return d_horizontal;
+    }
+
+    for (int depth = 0; depth <= level.height; ++depth)
+    {
+        int pos = (static_cast<int>(hy) >> 6) * level.width + (static_cast<int>(hx) >> 6);
+        bool hit = pos > 0 && pos < level.width * level.height && level[pos] > 0;
+        if (hit)
+        {
+            hmt = level[pos] - 1;
+            d_horizontal = cos(theta) * (hx - px) - sin(theta) * (hy - py);
+
+            break;
+        }
+
+        hx += ox;
+        hy += oy;
+    }
+
+    return d_horizontal;
+}
+
+void fill_wall_column(const Texture& texture, std::span<uint8_t> pixels, int ray,
+                      int wall_height, int tx, int light_level)
+{
+    double ty_step = 64.0 / static_cast<double>(wall_height);
+    double ty_offset = 0;
+
+    if (wall_height > RENDER_HEIGHT)
+    {
+        ty_offset = (wall_height - RENDER_HEIGHT) / 2;
+        wall_height = RENDER_HEIGHT;
+    }
+
+    int offset = (RENDER_HEIGHT / 2) - (wall_height >> 1);
+    double ty = ty_offset * ty_step;
+
+    for (int y = 0; y < wall_height; ++y)
+    {
+        const int pixel = (static_cast<int>(ty) * 64 + tx);
+        const uint32_t color = texture[pixel];
+
+        const uint8_t r = std::min<int>(255, (color >> 16) * light_level / FULL_BRIGHT);
+        const uint8_t g = std::min<int>(255, ((color >> 8) & 0xFF) * light_level / FULL_BRIGHT);
+        const uint8_t b = std::min<int>(255, (color & 0xFF) * light_level / FULL_BRIGHT);
+
+        if (r > 0 || g > 0 || b > 0)
+        {
+            int pixel_pointer = ((y + offset) * (RENDER_WIDTH) + ray) * 3;
+            pixels[pixel_pointer++] = r;
+            pixels[pixel_pointer++] = g;
+            pixels[pixel_pointer++] = b;
+        }
+
+        ty += ty_step;
+    }
+}
+
+void render_view(const Level& level, const TextureTable& textures, const Camera& camera,
+                 std::span<uint8_t> pixels, std::span<int> depth, const Lightmap* lightmap)
+{
+    int vmt = 0, hmt = 0;
+
+    double pa = camera.angle;
+    double r_angle = clamp_to_unit_circle(pa + 30);
+
+    double vx, vy;
+    double hx, hy;
+
+    std::memset(pixels.data(), 0, RENDER_WIDTH * RENDER_HEIGHT * 3 * sizeof(uint8_t));
+
+    for (int ray = 0; ray < RENDER_WIDTH; ++ray)
+    {
+        double theta = degrees_to_radians(r_angle);
+        double tangent = tan(theta);
+
+        double d_horizontal = Reference::calculate_horizontal_hits(level, camera.x, camera.y, theta,
+                                                                   tangent, hx, hy, hmt);
+        double d_vertical = Reference::calculate_vertical_hits(level, camera.x, camera.y, theta,
+                                                               tangent, vx, vy, vmt);
+        double shade = 1;
+
+        if (d_vertical < d_horizontal)
+        {
+            hx = vx;
+            hy = vy;
+            d_horizontal = d_vertical;
+            hmt = vmt;
+        }
+        else
+            shade = 0.5;
+
+        if (!std::isfinite(d_horizontal))
+        {
+            depth[ray] = INT_MAX;
+            r_angle = clamp_to_unit_circle(r_angle - 60.0 / RENDER_WIDTH);
+            continue;
+        }
+
+        d_horizontal *= cos(degrees_to_radians(clamp_to_unit_circle(pa - r_angle)));
+        depth[ray] = d_horizontal;
+
+        int wall_height = (64 * RENDER_HEIGHT) / d_horizontal;
+        int tx;
+
+        if (shade == 1)
+        {
+            tx = static_cast<int>(hy) % 64;
+            if (camera.angle > 90 && camera.angle < 270) tx = 63 - tx;
+        }
+        else
+        {
+            tx = static_cast<int>(hx) % 64;
+            if (camera.angle > 180) tx = 63 - tx;
+        }
+
+        // The face the ray hits follows from the direction it travels in.
+        int light_level = FULL_BRIGHT;
+        const int cx = static_cast<int>(hx) >> 6;
+        const int cy = static_cast<int>(hy) >> 6;
+
+        if (lightmap && cx >= 0 && cx < level.width && cy >= 0 && cy < level.height)
+        {
+            Face face;
+            if (shade == 1)
+                face = (cos(theta) > 0) ? WEST : EAST;
+            else
+                face = (sin(theta) > 0) ? SOUTH : NORTH;
+
+            light_level = lightmap->light_level(cx, cy, face);
+        }
+
+        fill_wall_column(*textures[hmt], pixels, ray, wall_height, tx, light_level);
+
+        r_angle = clamp_to_unit_circle(r_angle - 60.0 / RENDER_WIDTH);
+    }
+}
+
+SpriteProjection project_sprite(const Camera& camera, double x, double y, double z)
+{
+    const double theta = degrees_to_radians(camera.angle);
+
+    double rx = x - camera.x;
+    double ry = y - camera.y;
+
+    double a = cos(theta) * ry + sin(theta) * rx;
+    double b = -sin(theta) * ry + cos(theta) * rx;
+
+    SpriteProjection projection;
+    projection.sx = (a * 108.0 / b) + (120 / 2);
+    projection.sy = (z * 108.0 / b) + (80 / 2);
+    projection.depth = b;
+
+    int scale = 32 * 80 / b;
+    scale = std::max(0, scale);
+    projection.scale = std::min(120, scale);
+
+    return projection;
+}
+
+bool load_texture(const std::string& name, std::vector<uint32_t>& texels)
+{
+    std::ifstream file("data/textures/" + name, std::ios::binary);
+    std::string s;
+
+    for (const char* expected : {"P6", "64 64", "255"})
+    {
+        if (!std::getline(file, s) || s != expected) return false;
+    }
+
+    texels.assign(64 * 64, 0);
+    for (uint32_t& texel : texels)
+    {
+        for (int channel = 0; channel < 3; ++channel)
+        {
+            const int c = file.get();
+            if (c == EOF) return false;
+
+            texel = (texel << 8) | c;
+        }
+    }
+
+    return true;
+}
+}  // namespace Reference
@@ -0,0 +1,40 @@
+#ifndef REFERENCE_H
+#define REFERENCE_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "engine/renderer.h"
+
+/*
+ * The plain scalar versions of the engine's kernels, kept as they were
+ * before any optimization. The benchmark uses them as a correctness oracle:
+ * an optimized kernel has to produce the same result as its reference.
+ * The hit functions keep the old bug where a ray that leaves the level
+ * wraps into another row and may hit a wall there; those rays aren't compared.
+ */
+namespace Reference
+{
+double calculate_vertical_hits(const Engine::Level& level, double px, double py, double theta,
+                               double tangent, double& vx, double& vy, int& vmt);
+double calculate_horizontal_hits(const Engine::Level& level, double px, double py, double theta,
+                                 double tangent, double& hx, double& hy, int& hmt);
+
+// The per-pixel wall loop: steps through the texture, shades each texel and skips black ones.
+void fill_wall_column(const Engine::Texture& texture, std::span<uint8_t> pixels, int ray,
+                      int wall_height, int tx, int light_level = Engine::FULL_BRIGHT);
+
+void render_view(const Engine::Level& level, const Engine::TextureTable& textures,
+                 const Engine::Camera& camera, std::span<uint8_t> pixels, std::span<int> depth,
+                 const Engine::Lightmap* lightmap = nullptr);
+
+Engine::SpriteProjection project_sprite(const Engine::Camera& camera, double x, double y,
+                                        double z);
+
+// Decodes a 64 by 64 P6 texture from data/textures one byte at a time.
+bool load_texture(const std::string& name, std::vector<uint32_t>& texels);
+}  // namespace Reference
+
+#endif  // REFERENCE_H
@@ -0,0 +1,115 @@
+#ifndef ASSET_MANAGER_H
+#define ASSET_MANAGER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "level.h"
+#include "texture.h"
+#include "thread_pool.h"
+
+namespace Engine
+{
+///////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DECLARATIONS
+///////////////////////////////////////////////////////////////////////////////
+
+// An immutable set of assets. A new set is published whenever a load completes.
+struct Assets
+{
+    TextureTable textures;
+    std::shared_ptr<const Level> level;  // Empty until a level has been loaded
+};
+
+struct LoadProgress
+{
+    int loaded = 0;
+    int failed = 0;
+    int total = 0;
+};
+
+struct ReloadStats
+{
+    int reloads = 0;
+    double last_ms = 0;  // From the file change until the new asset was published
+    double max_ms = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ASSET MANAGER
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Loads textures, sprites and levels on background threads. Every load
+ * returns immediately; a texture handle refers to a placeholder until the
+ * decoded texture is published. Readers take a snapshot of the assets with
+ * current(), which stays valid and unchanged for as long as they hold it.
+ */
+class AssetManager
+{
+   public:
+    explicit AssetManager(unsigned int threads = 2);
+
+    // Queues a texture from data/textures and returns its index in the texture table.
+    int load_texture(const std::string& name);
+
+    // Queues a level from data/levels, which replaces the current level once loaded.
+    void load_level(const std::string& name);
+
+    std::shared_ptr<const Assets> current() const;
+
+    LoadProgress progress() const;
+
+    // Blocks until every queued load has finished.
+    void wait();
+
+    /*
+     * Decodes a texture or level again after its file changed. Only the asset
+     * itself is replaced in the next snapshot, everything else is shared with
+     * the previous one. Returns false when name was never loaded.
+     */
+    bool reload_texture(const std::string& name, std::chrono::steady_clock::time_point changed);
+    bool reload_level(const std::string& name, std::chrono::steady_clock::time_point changed);
+
+    ReloadStats reload_stats() const;
+
+   private:
+    const std::shared_ptr<const Texture> placeholder;
+
+    std::atomic<std::shared_ptr<const Assets>> assets;
+    std::mutex publish_mutex;
+
+    // Guarded by publish_mutex. Every decode gets a serial number, and only the
+    // newest one per asset is published, so slow decodes can't undo fast ones.
+    std::unordered_map<std::string, int> texture_handles;
+    std::unordered_map<std::string, uint64_t> latest_serial;
+    std::string level_name;
+    uint64_t serial = 0;
+
+    mutable std::mutex progress_mutex;
+    std::condition_variable finished;
+    LoadProgress status;
+    ReloadStats reloads;
+
+    ThreadPool pool;
+
+    // Copies the current assets, applies edit, and atomically publishes the result.
+    void publish(const std::function<void(Assets&)>& edit);
+    void complete(bool ok);
+
+    // Return whether the file decoded; published is set when it was also swapped in.
+    bool decode_texture(const std::string& name, int handle, uint64_t id, bool& published);
+    bool decode_level(const std::string& name, uint64_t id, bool& published);
+    uint64_t next_serial(const std::string& name);
+    void record_reload(const std::string& name, std::chrono::steady_clock::time_point changed);
+};
+}  // namespace Engine
+
+#endif  // ASSET_MANAGER_H
@@ -0,0 +1,45 @@
+#ifndef ASSET_WATCHER_H
+#define ASSET_WATCHER_H
+
+#include <memory>
+#include <thread>
+
+#include "asset_manager.h"
+
+namespace Engine
+{
+/*
+ * Watches data/textures and data/levels with inotify, and asks the asset
+ * manager to reload every file that was written or moved into place. The
+ * decoding happens on the asset manager's threads and the result is picked
+ * up by the next frame, so rendering never waits on a reload.
+ */
+class AssetWatcher
+{
+   public:
+    ~AssetWatcher();
+
+    AssetWatcher(const AssetWatcher&) = delete;
+    AssetWatcher& operator=(const AssetWatcher&) = delete;
+
+    // Returns nullptr when inotify is unavailable or the directories can't be watched.
+    static std::unique_ptr<AssetWatcher> start(AssetManager& manager);
+
+   private:
+    AssetWatcher(AssetManager& manager, int inotify_fd, int stop_fd, int textures_wd,
+                 int levels_wd);
+
+    AssetManager& manager;
+
+    const int inotify_fd;
+    const int stop_fd;  // eventfd that wakes the watcher thread to shut down
+    const int textures_wd;
+    const int levels_wd;
+
+    std::thread watcher;
+
+    void work();
+};
+}  // namespace Engine
+
+#endif  // ASSET_WATCHER_H
@@ -0,0 +1,97 @@
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include <memory>
+#include <span>
+
+#include "asset_manager.h"
+#include "game.h"
+#include "lightmap.h"
+#include "renderer.h"
+#include "snapshot.h"
+#include "thread_pool.h"
+
+namespace Engine
+{
+// The light the player carries, see EngineContext::toggle_torch.
+const double TORCH_RADIUS = 4 * 64;
+const double TORCH_INTENSITY = 0.8;
+
+// Rewind ticks per second of game time, independent of the frame rate.
+const int REWIND_RATE = 60;
+const double REWIND_INTERVAL = 1000.0 / REWIND_RATE;
+
+// Most game time a single step records or rewinds, so a stall doesn't flood the buffer.
+const double MAX_REWIND_STEP = 1000;
+
+/*
+ * One game instance: its world, the frame it renders into and its timing.
+ * Contexts share no mutable state, so any number of them can be stepped
+ * and rendered at the same time. The assets are immutable and shared, each
+ * context holds a reference to the snapshot it currently uses.
+ */
+class EngineContext
+{
+   public:
+    explicit EngineContext(std::shared_ptr<const Assets> _assets)
+        : assets(std::move(_assets))
+    {
+        if (assets->level) game.level = *assets->level;
+        game.keep_player_in_level();
+
+        lightmap.bake(game.level);
+        torch = lightmap.add_light(game.level, {game.player.x, game.player.y, TORCH_RADIUS,
+                                                TORCH_INTENSITY, false});
+    }
+
+    // Switches to a newer asset snapshot, taking over its level if that changed.
+    void update_assets(std::shared_ptr<const Assets> latest);
+
+    // Starts recording REWIND_RATE ticks per second, so the context can be rewound.
+    void enable_rewind(size_t max_ticks, size_t max_bytes);
+
+    /*
+     * Advances the world by dt milliseconds, recording a tick for every
+     * REWIND_INTERVAL that passed. While rewinding is set, a step instead
+     * goes back a tick for every REWIND_INTERVAL, so rewinding runs at the
+     * speed the game was played. The first step after rewinding forgets the
+     * ticks that were rewound and continues from there.
+     */
+    void step(double dt);
+
+    // Renders the world as seen by the player into frame.
+    void render();
+
+    // Turns the light around the player on or off.
+    void toggle_torch();
+
+    /*
+     * Re-bakes the lightmap when the level has other cells than it was baked
+     * for, and moves the torch to the player. Called after anything that may
+     * have changed either: a step, a seek, a load or new assets.
+     */
+    void update_lighting();
+
+    Game game;
+    std::shared_ptr<const Assets> assets;
+    FrameBuffer frame;
+
+    Lightmap lightmap;
+    int torch;  // Dynamic light following the player
+
+    std::unique_ptr<RewindBuffer> rewind;
+    bool rewinding = false;
+    size_t rewind_position = 0;  // Ticks behind the latest recorded tick
+    double rewind_time = 0;      // Game time in ms not yet recorded or rewound
+
+    double old_time_since_frame = 0;
+    double time_since_frame = 0;
+    double delta_time = 0;
+};
+
+// Steps every context by dt and renders it, with the contexts spread over the pool.
+void tick_contexts(std::span<const std::unique_ptr<EngineContext>> contexts, double dt,
+                   ThreadPool& pool);
+}  // namespace Engine
+
+#endif  // CONTEXT_H
@@ -18,6 +18,9 @@ class Enemy
     double x;
     double y;
     double z;
+
+    // Whether the player was in view at the last tick, see Game::update_sight.
+    bool sees_player = false;
 };
 
 class Skull : public Enemy
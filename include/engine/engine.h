@@ -9,7 +9,13 @@
 #include <iostream>
 #include <vector>
 
+#include "asset_manager.h"
+#include "asset_watcher.h"
+#include "context.h"
+#include "frame_sink.h"
 #include "game.h"
+#include "input.h"
+#include "renderer.h"
 #include "texture.h"
 
 namespace Engine
@@ -18,28 +24,34 @@ namespace Engine
 // CONSTANTS AND DECLARATIONS
 ///////////////////////////////////////////////////////////////////////////////
 
-const int SCREEN_WIDTH = 960;
-const int SCREEN_HEIGHT = 640;
-constexpr int RENDER_WIDTH = SCREEN_WIDTH / 2;
-constexpr int RENDER_HEIGHT = SCREEN_HEIGHT / 2;
+const std::string QUICKSAVE = "quicksave.sav";
+
+// Recordings are written at this fixed frame rate, whatever rate the game runs at.
+const int RECORD_FPS = 60;
+
+// A pointer warp that hasn't shown up after this many ms is given up on, so another can be made.
+const int WARP_TIMEOUT = 250;
 
 ///////////////////////////////////////////////////////////////////////////////
 // VARIABLES
 ///////////////////////////////////////////////////////////////////////////////
 
-inline double old_time_since_frame = 0;
-inline double time_since_frame = 0;
-inline double delta_time = 0;
-
-inline std::vector<Texture> textures;
-inline std::vector<int> depth_buffer = std::vector<int>(SCREEN_WIDTH, 0);
+inline AssetManager asset_manager;
+inline std::unique_ptr<AssetWatcher> asset_watcher;
 const int window_id = 1;
 
-inline Game game{};
+// The instance shown in the window and driven by the GLUT hooks.
+inline EngineContext context{asset_manager.current()};
 
-inline uint8_t pixel_buffer[RENDER_WIDTH * RENDER_HEIGHT * 3];  // 3 channels (RGB)
 inline GLuint texture_id;
 
+// Filled by the GLUT input hooks, emptied once per tick by sample_input.
+inline InputQueue input;
+
+// When set, every rendered frame is also streamed out through this sink.
+inline std::unique_ptr<FrameSink> frame_sink;
+inline double next_record_time = -1;  // Elapsed time in ms at which the next frame is due
+
 ///////////////////////////////////////////////////////////////////////////////
 // RENDER FUNCTIONS
 ///////////////////////////////////////////////////////////////////////////////
@@ -56,6 +68,8 @@ void render_scene();
 void button_down(unsigned char key, int x, int y);
 void button_up(unsigned char key, int x, int y);
 void look(int x, int y);
+void sample_input();
+void record_frame();
 void display();
 void initialize(int argc, char* argv[]);
 
@@ -0,0 +1,105 @@
+#ifndef FRAME_SINK_H
+#define FRAME_SINK_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Engine
+{
+///////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DECLARATIONS
+///////////////////////////////////////////////////////////////////////////////
+
+enum class FrameFormat
+{
+    RAW,  // Packed RGB24 frames without any header
+    PPM,  // One binary PPM image (P6) per frame, concatenated
+    Y4M,  // YUV4MPEG2 stream with 4:4:4 planes
+};
+
+struct FrameSinkStats
+{
+    uint64_t submitted = 0;
+    uint64_t written = 0;
+    uint64_t dropped = 0;
+    uint64_t bytes = 0;
+    double seconds = 0;  // Time spent inside writev
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// FRAME SINK
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Streams rendered frames to a file descriptor from a writer thread.
+ * Frames are copied into a bounded ring, and the writer flushes every
+ * queued frame with a single writev. A frame shown for several intervals
+ * is copied once and written as often as it repeats. When the ring is
+ * full, the frame is dropped instead of waiting on the writer, so
+ * rendering never blocks on I/O.
+ */
+class FrameSink
+{
+   public:
+    FrameSink(int fd, FrameFormat format, int width, int height, int fps, int capacity = 16);
+    ~FrameSink();
+
+    FrameSink(const FrameSink&) = delete;
+    FrameSink& operator=(const FrameSink&) = delete;
+
+    // Opens path for writing, "-" is stdout. Returns nullptr when it can't be opened.
+    static std::unique_ptr<FrameSink> open(const std::string& path, FrameFormat format,
+                                           int width, int height, int fps);
+
+    // Picks the format from the extension of path (.ppm, .y4m), defaulting to raw.
+    static FrameFormat format_from_path(const std::string& path);
+
+    /*
+     * Queues a width * height * 3 byte RGB frame, to be written repeat times
+     * in a row. Returns false if it was dropped or mis-sized.
+     */
+    bool submit(std::span<const uint8_t> pixels, int repeat = 1);
+
+    FrameSinkStats stats() const;
+
+   private:
+    const int fd;
+    const FrameFormat format;
+    const int width;
+    const int height;
+    const int fps;
+    const size_t frame_size;
+
+    std::string frame_header;
+    std::vector<std::vector<uint8_t>> ring;
+    std::vector<int> repeats;                  // Times the frame in each slot is written
+    std::vector<std::vector<uint8_t>> planes;  // Y4M conversion output, one per slot
+
+    // head is only written by submit, tail only by the writer thread.
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0};
+    std::atomic<uint32_t> signal{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> failed{false};
+
+    std::atomic<uint64_t> submitted{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> nanoseconds{0};
+
+    std::thread writer;
+
+    void write_stream_header();
+    bool write_frames(uint64_t first, uint64_t last);
+    void convert_to_yuv(const std::vector<uint8_t>& rgb, std::vector<uint8_t>& yuv) const;
+    void work();
+};
+}  // namespace Engine
+
+#endif  // FRAME_SINK_H
@@ -8,6 +8,7 @@
 #include "enemy.h"
 #include "level.h"
 #include "player.h"
+#include "query.h"
 #include "utility.h"
 
 namespace Engine
@@ -18,7 +19,9 @@ namespace Engine
 
 const int MAP_WIDTH = 12;
 const int MAP_HEIGHT = 12;
-const int MAX_DEPTH = std::max(MAP_WIDTH, MAP_HEIGHT);
+
+// Degrees turned per pixel of horizontal pointer movement.
+const double MOUSE_SENSITIVITY = 0.128;
 
 typedef struct
 {
@@ -41,10 +44,20 @@ class Game
     {
     }
 
-    void mouse_look(int dx, double dt);
+    // Turns by dx pixels of pointer movement, fractions of a pixel included.
+    void mouse_look(double dx);
 
     void keys_handler(double dt);
 
+    /*
+     * Moves the player to the first open cell when the level was replaced and
+     * the player now stands in a wall or outside of it.
+     */
+    void keep_player_in_level();
+
+    // Checks for every enemy whether it has a line of sight to the player.
+    void update_sight();
+
     template <typename enemy_type>
     requires std::derived_from<enemy_type, Enemy>
     void add_enemy(double x, double y, double z)
@@ -0,0 +1,67 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+
+namespace Engine
+{
+///////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DECLARATIONS
+///////////////////////////////////////////////////////////////////////////////
+
+enum class InputType : uint8_t
+{
+    KEY_DOWN,
+    KEY_UP,
+    MOTION,  // Horizontal pointer movement of dx pixels
+};
+
+struct InputEvent
+{
+    InputType type;
+    unsigned char key = 0;
+    int dx = 0;
+};
+
+// Everything that happened since the previous sample, coalesced.
+struct InputSample
+{
+    std::bitset<256> held;     // Keys that are down at the time of the sample
+    std::bitset<256> pressed;  // Keys that went down since the previous sample
+    double look_dx = 0;        // Sum of the pointer movement, in pixels
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// INPUT QUEUE
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Lock-free input state shared by a single producer and a single consumer.
+ * The input callbacks push events as they arrive and the simulation takes
+ * everything at once per tick with sample, so no event triggers any work
+ * of its own. Events are coalesced as they are pushed: keys set bits in
+ * the held and pressed sets, and pointer movement is added to a running
+ * sum. Nothing is queued, so no event can be dropped, however many
+ * arrive between two samples.
+ */
+class InputQueue
+{
+   public:
+    // Called by the producer only.
+    void push(const InputEvent& event);
+
+    // Called by the consumer only, takes everything since the previous sample.
+    InputSample sample();
+
+   private:
+    // 256 key bits each, in words of 64. sample reads held and takes pressed.
+    alignas(64) std::array<std::atomic<uint64_t>, 4> held{};
+    alignas(64) std::array<std::atomic<uint64_t>, 4> pressed{};
+    alignas(64) std::atomic<int64_t> look_dx{0};
+};
+}  // namespace Engine
+
+#endif  // INPUT_H
@@ -1,10 +1,27 @@
 #ifndef LEVEL_H
 #define LEVEL_H
 
+#include <string>
 #include <vector>
 
 namespace Engine
 {
+// Walls show one of the first WALL_TEXTURES textures of the texture table, the rest are sprites.
+const int WALL_TEXTURES = 2;
+
+/*
+ * A point light, in the same units as the player. Its brightness falls off
+ * linearly to zero at radius, intensity 1 lights a wall as its texture is.
+ */
+struct Light
+{
+    double x;
+    double y;
+    double radius;
+    double intensity;
+    bool on = true;
+};
+
 class Level
 {
    public:
@@ -14,11 +31,40 @@ class Level
     {
     }
 
+    Level(int w, int h, std::vector<int> cells)
+        : width(w),
+          height(h),
+          data(std::move(cells))
+    {
+    }
+
     int operator[](int i) const;
     int &operator[](int i);
 
-    const int width;
-    const int height;
+    // Whether the cell at (cx, cy) is a wall. Everything outside the level counts as one.
+    bool solid(int cx, int cy) const;
+
+    // Whether value can be stored in a cell: empty space, or a wall with a wall texture.
+    static bool valid_cell(int value);
+
+    /*
+     * Loads a level from data/levels. The file starts with the width and the
+     * height, followed by width * height cells: 0 is empty space, a value up
+     * to WALL_TEXTURES is a wall showing texture value - 1. The cells can be
+     * followed by the number of static lights and a line of x, y, radius and
+     * intensity per light, measured in cells. In case the file is malformed,
+     * the problem is reported and false is returned.
+     */
+    bool load(std::string name);
+
+    int width;
+    int height;
+
+    // Lights that never move, baked into the lightmap when the level is loaded.
+    std::vector<Light> lights;
+
+    // Bumped whenever other cells are taken over, so what was derived from them is redone.
+    unsigned generation = 0;
 
    private:
     std::vector<int> data = {
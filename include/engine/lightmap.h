@@ -0,0 +1,79 @@
+#ifndef LIGHTMAP_H
+#define LIGHTMAP_H
+
+#include <cstdint>
+#include <vector>
+
+#include "level.h"
+#include "texture.h"
+
+namespace Engine
+{
+///////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DECLARATIONS
+///////////////////////////////////////////////////////////////////////////////
+
+// Light every wall face gets, on top of the lights. North and south faces get half.
+const double AMBIENT_LIGHT = 0.7;
+
+enum Face
+{
+    NORTH,  // Facing -y
+    EAST,   // Facing +x
+    SOUTH,  // Facing +y
+    WEST,   // Facing -x
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// LIGHTMAP
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The light level of every wall face of a level. Static lights are baked
+ * once, together with the ambient light. Dynamic lights are added on top,
+ * and changing one relights only the faces within its radius, before and
+ * after the change. A light reaches a face when the face is turned towards
+ * it and nothing in the grid blocks the line between them.
+ */
+class Lightmap
+{
+   public:
+    // Bakes the ambient light and the static lights of level, dynamic lights are kept.
+    void bake(const Level& level);
+
+    // Whether the lightmap was baked for the cells the level has now.
+    bool matches(const Level& level) const;
+
+    // Adds a dynamic light and returns its id.
+    int add_light(const Level& level, const Light& light);
+
+    // Moves, resizes or toggles a dynamic light.
+    void set_light(const Level& level, int id, const Light& light);
+
+    const Light& light(int id) const;
+
+    // The light level of a face of the wall at (cx, cy), between 0 and LIGHT_LEVELS - 1.
+    uint8_t light_level(int cx, int cy, Face face) const
+    {
+        return levels[(cy * width + cx) * 4 + face];
+    }
+
+    // Number of faces relit by the last change to a dynamic light.
+    int relit() const;
+
+   private:
+    int width = 0;
+    int height = 0;
+    unsigned generation = 0;  // Of the level baked for
+
+    std::vector<float> baked;     // Ambient and static light per face
+    std::vector<uint8_t> levels;  // Baked plus dynamic light, quantized
+    std::vector<Light> lights;    // Dynamic lights
+    int relit_faces = 0;
+
+    void relight(const Level& level, const Light& light);
+    void relight(const Level& level, int x0, int y0, int x1, int y1);
+};
+}  // namespace Engine
+
+#endif  // LIGHTMAP_H
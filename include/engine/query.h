@@ -0,0 +1,102 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include <cstdint>
+#include <span>
+
+#include "level.h"
+#include "thread_pool.h"
+
+namespace Engine
+{
+///////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DECLARATIONS
+///////////////////////////////////////////////////////////////////////////////
+
+// Queries are answered in chunks of this size, so a batch costs a few handouts per thread.
+const int QUERY_CHUNK = 256;
+
+// A line between two points, in the same units as the player.
+struct Segment
+{
+    double x0;
+    double y0;
+    double x1;
+    double y1;
+};
+
+// Something a trace can hit, approximated by a circle.
+struct Target
+{
+    double x;
+    double y;
+    double radius;
+};
+
+// A shot from (x, y) in the direction of angle, in degrees like the player's.
+struct Trace
+{
+    double x;
+    double y;
+    double angle;
+    double range;
+};
+
+/*
+ * What a trace hit first. wall is the value of the wall cell that was hit,
+ * 0 for the edge of the level, and target the index of the target. Both are
+ * -1 when not hit. When the trace hit nothing, distance is its range.
+ */
+struct TraceHit
+{
+    double x;
+    double y;
+    double distance;
+    int wall = -1;
+    int target = -1;
+};
+
+// A sound made at (x0, y0) that is heard at (x1, y1) when it gets there within range.
+struct SoundProbe
+{
+    double x0;
+    double y0;
+    double x1;
+    double y1;
+    double range;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// QUERY FUNCTIONS
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Whether the end of segment can be seen from its start. The grid is walked
+ * cell by cell and the walk stops at the first wall, or when it passes the
+ * end. Leaving the level counts as hitting a wall.
+ */
+bool line_of_sight(const Level& level, const Segment& segment);
+
+// Walks the trace through the grid, then checks the targets in front of the wall it hit.
+TraceHit hitscan(const Level& level, const Trace& trace, std::span<const Target> targets);
+
+/*
+ * The distance a sound travels from the start to the end of probe, going
+ * around walls through open cells, or INFINITY if it doesn't get there
+ * within range. The distance is counted in steps between cell centers.
+ */
+double sound_distance(const Level& level, const SoundProbe& probe);
+
+/*
+ * Batched versions of the above, answering every query with the queries
+ * spread over the pool. Results are written at the index of their query.
+ */
+void lines_of_sight(const Level& level, std::span<const Segment> segments,
+                    std::span<uint8_t> visible, ThreadPool& pool);
+void hitscans(const Level& level, std::span<const Trace> traces, std::span<const Target> targets,
+              std::span<TraceHit> hits, ThreadPool& pool);
+void sound_distances(const Level& level, std::span<const SoundProbe> probes,
+                     std::span<double> distances, ThreadPool& pool);
+}  // namespace Engine
+
+#endif  // QUERY_H
@@ -0,0 +1,92 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "level.h"
+#include "lightmap.h"
+#include "texture.h"
+#include "thread_pool.h"
+
+namespace Engine
+{
+///////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DECLARATIONS
+///////////////////////////////////////////////////////////////////////////////
+
+const int SCREEN_WIDTH = 960;
+const int SCREEN_HEIGHT = 640;
+constexpr int RENDER_WIDTH = SCREEN_WIDTH / 2;
+constexpr int RENDER_HEIGHT = SCREEN_HEIGHT / 2;
+
+// Walls up to this height use a precomputed scaler, taller ones compute theirs per column.
+constexpr int MAX_SCALED_HEIGHT = 8 * RENDER_HEIGHT;
+
+// A point of view into the level, in the same units as the player.
+struct Camera
+{
+    double x;
+    double y;
+    double angle;
+};
+
+// Where a sprite lands on screen, in the coordinates used by render_enemies.
+struct SpriteProjection
+{
+    double sx;
+    double sy;
+    double depth;
+    int scale;
+};
+
+// Output of a single view: an RGB image and the wall distance per column.
+struct FrameBuffer
+{
+    std::vector<uint8_t> pixels = std::vector<uint8_t>(RENDER_WIDTH * RENDER_HEIGHT * 3, 0);
+    std::vector<int> depth = std::vector<int>(RENDER_WIDTH, 0);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// RENDER FUNCTIONS
+///////////////////////////////////////////////////////////////////////////////
+
+double calculate_vertical_hits(const Level& level, double px, double py, double theta,
+                               double tangent, double& vx, double& vy, int& vmt);
+double calculate_horizontal_hits(const Level& level, double px, double py, double theta,
+                                 double tangent, double& hx, double& hy, int& hmt);
+
+/*
+ * Projects a sprite at (x, y) and height z into the view of camera. The sine
+ * and cosine of the camera angle are passed in, so they are computed once
+ * per frame rather than once per sprite.
+ */
+SpriteProjection project_sprite(const Camera& camera, double cos_theta, double sin_theta, double x,
+                                double y, double z);
+
+/*
+ * Draws a wall column of wall_height pixels (before clipping to the screen),
+ * centered vertically in column ray. texels is a texture column as returned
+ * by Texture::column.
+ */
+void draw_wall_column(std::span<uint8_t> pixels, int ray, int wall_height, const uint8_t* texels);
+
+/*
+ * Raycasts the walls of the level as seen from camera. The level and the
+ * textures are only read, so any number of views can render concurrently.
+ * pixels holds RENDER_WIDTH * RENDER_HEIGHT * 3 bytes, depth RENDER_WIDTH.
+ * With a lightmap, every column shows its texture at the light level of
+ * the wall face it hits; without one, walls are drawn as their textures are.
+ */
+void render_view(const Level& level, const TextureTable& textures, const Camera& camera,
+                 std::span<uint8_t> pixels, std::span<int> depth,
+                 const Lightmap* lightmap = nullptr);
+
+// Renders cameras[i] into frames[i] for every camera, spread over the pool, lit like render_view.
+void render_views(const Level& level, const TextureTable& textures,
+                  std::span<const Camera> cameras, std::span<FrameBuffer> frames,
+                  ThreadPool& pool, const Lightmap* lightmap = nullptr);
+}  // namespace Engine
+
+#endif  // RENDERER_H
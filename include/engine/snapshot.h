@@ -0,0 +1,79 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "game.h"
+
+namespace Engine
+{
+///////////////////////////////////////////////////////////////////////////////
+// SNAPSHOTS
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * A snapshot is the full state of a game as a flat byte buffer: the player,
+ * the level cells and the enemies. Held keys are input, not state, so they
+ * are left out. Snapshots of the same game have the same layout as long as
+ * the level size and the number of enemies stay the same.
+ */
+std::vector<uint8_t> save_snapshot(const Game& game);
+
+// Restores a snapshot made by save_snapshot. Returns false if data is malformed or has bad cells.
+bool load_snapshot(Game& game, std::span<const uint8_t> data);
+
+bool save_snapshot_file(const std::string& path, const Game& game);
+bool load_snapshot_file(const std::string& path, Game& game);
+
+///////////////////////////////////////////////////////////////////////////////
+// REWIND BUFFER
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Records one snapshot per tick, to seek back to any recent tick. Every
+ * keyframe_interval ticks a full snapshot is kept; the ticks in between are
+ * stored as the XOR against that keyframe, run-length encoded. Since little
+ * changes per tick, those deltas are mostly a few runs of zeros. Seeking
+ * decodes one keyframe and one delta. When the buffer exceeds its tick or
+ * byte budget, the oldest keyframe and its deltas are dropped together.
+ */
+class RewindBuffer
+{
+   public:
+    RewindBuffer(size_t max_ticks, size_t max_bytes, int keyframe_interval = 60);
+
+    void record(const Game& game);
+
+    // Restores the state of ticks_ago ticks before the latest record, 0 being the latest.
+    bool seek(Game& game, size_t ticks_ago) const;
+
+    // Forgets the ticks_ago most recent ticks, so recording continues after a rewind.
+    void truncate(size_t ticks_ago);
+
+    size_t ticks() const;
+    size_t bytes() const;
+
+   private:
+    struct Group
+    {
+        std::vector<uint8_t> keyframe;
+        std::vector<std::vector<uint8_t>> deltas;
+    };
+
+    const size_t max_ticks;
+    const size_t max_bytes;
+    const int keyframe_interval;
+
+    std::deque<Group> groups;
+    size_t tick_count = 0;
+    size_t byte_count = 0;
+
+    void evict();
+};
+}  // namespace Engine
+
+#endif  // SNAPSHOT_H
@@ -2,35 +2,53 @@
 #define TEXTURE_H
 
 #include <algorithm>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace Engine
 {
+// Textures keep a shaded copy per light level, level FULL_BRIGHT is the texture as it is.
+constexpr int LIGHT_LEVELS = 32;
+constexpr int FULL_BRIGHT = 16;
+
 class Texture
 {
    public:
+    Texture() = default;
     Texture(std::string name);
 
+    // A 64 by 64 checkerboard, shown while the real texture is loading.
+    static Texture placeholder();
+
     uint32_t operator[](int i) const;
-    uint32_t& operator[](int i);
 
-   private:
-    std::vector<uint32_t> data;
+    // The 64 texels of column x shaded to light_level, as packed RGB bytes, top to bottom.
+    const uint8_t* column(int x, int light_level = FULL_BRIGHT) const;
 
     /*
-     * This statemachine loads PPM files.
+     * This function loads PPM files.
      * It ensures the following image properties:
      * - magic number P6
      * - 64 by 64 pixels
      * - colours expressed in unsigned bytes (255)
      *
-     * In case of violation of these properties, the program
-     * states the problem and exits.
+     * In case of violation of these properties, the problem
+     * is reported and false is returned.
      */
-    void load(std::string name);
+    bool load(std::string name);
+
+   private:
+    std::vector<uint32_t> data;
+    std::vector<uint8_t> columns;  // data transposed to column-major RGB, once per light level
+
+    void build_columns();
 };
+
+using TextureTable = std::vector<std::shared_ptr<const Texture>>;
 }  // namespace Engine
 
-#endif  // TEXTURE_H
\ No newline at end of file
+#endif  // TEXTURE_H
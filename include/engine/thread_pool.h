@@ -0,0 +1,48 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Engine
+{
+class ThreadPool
+{
+   public:
+    // A pool of zero threads is valid, all work then runs on the calling thread.
+    explicit ThreadPool(unsigned int threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads that take part in parallel_for, including the caller.
+    unsigned int concurrency() const;
+
+    /*
+     * Calls task(i) for every i in [0, count). Indices are handed out one at a
+     * time to the workers and the calling thread, so uneven tasks balance out.
+     * Returns once every task has finished.
+     */
+    void parallel_for(int count, const std::function<void(int)>& task);
+
+    // Runs job on one of the workers, or right away when the pool has none.
+    void submit(std::function<void()> job);
+
+   private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> queue;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void enqueue(std::function<void()> job);
+    void work();
+};
+}  // namespace Engine
+
+#endif  // THREAD_POOL_H
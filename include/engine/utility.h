@@ -1,6 +1,8 @@
 #ifndef UTILITY_H
 #define UTILITY_H
 
+#include <cmath>
+
 namespace Engine
 {
 ///////////////////////////////////////////////////////////////////////////////
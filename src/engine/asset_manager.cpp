@@ -0,0 +1,210 @@
+#include "engine/asset_manager.h"
+
+#include <iostream>
+
+namespace Engine
+{
+AssetManager::AssetManager(unsigned int threads)
+    : placeholder(std::make_shared<const Texture>(Texture::placeholder())),
+      assets(std::make_shared<const Assets>()),
+      pool(threads + 1)  // The pool counts the calling thread, which does not take jobs.
+{
+}
+
+int AssetManager::load_texture(const std::string& name)
+{
+    int handle;
+    publish(
+        [&](Assets& next)
+        {
+            handle = next.textures.size();
+            next.textures.push_back(placeholder);
+            texture_handles[name] = handle;
+        });
+
+    {
+        std::lock_guard<std::mutex> lock(progress_mutex);
+        status.total++;
+    }
+
+    const uint64_t id = next_serial(name);
+    pool.submit(
+        [this, name, handle, id]()
+        {
+            bool published;
+            complete(decode_texture(name, handle, id, published));
+        });
+
+    return handle;
+}
+
+void AssetManager::load_level(const std::string& name)
+{
+    {
+        std::lock_guard<std::mutex> lock(publish_mutex);
+        level_name = name;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(progress_mutex);
+        status.total++;
+    }
+
+    const uint64_t id = next_serial(name);
+    pool.submit(
+        [this, name, id]()
+        {
+            bool published;
+            complete(decode_level(name, id, published));
+        });
+}
+
+std::shared_ptr<const Assets> AssetManager::current() const
+{
+    return assets.load(std::memory_order_acquire);
+}
+
+LoadProgress AssetManager::progress() const
+{
+    std::lock_guard<std::mutex> lock(progress_mutex);
+    return status;
+}
+
+void AssetManager::wait()
+{
+    std::unique_lock<std::mutex> lock(progress_mutex);
+    finished.wait(lock, [this]() { return status.loaded + status.failed == status.total; });
+}
+
+bool AssetManager::reload_texture(const std::string& name,
+                                  std::chrono::steady_clock::time_point changed)
+{
+    int handle;
+
+    {
+        std::lock_guard<std::mutex> lock(publish_mutex);
+
+        auto it = texture_handles.find(name);
+        if (it == texture_handles.end()) return false;
+
+        handle = it->second;
+    }
+
+    const uint64_t id = next_serial(name);
+    pool.submit(
+        [this, name, handle, id, changed]()
+        {
+            // A newer reload of the same file may have superseded this one.
+            bool published;
+            if (decode_texture(name, handle, id, published) && published)
+                record_reload(name, changed);
+        });
+
+    return true;
+}
+
+bool AssetManager::reload_level(const std::string& name,
+                                std::chrono::steady_clock::time_point changed)
+{
+    {
+        std::lock_guard<std::mutex> lock(publish_mutex);
+        if (name != level_name) return false;
+    }
+
+    const uint64_t id = next_serial(name);
+    pool.submit(
+        [this, name, id, changed]()
+        {
+            bool published;
+            if (decode_level(name, id, published) && published) record_reload(name, changed);
+        });
+
+    return true;
+}
+
+ReloadStats AssetManager::reload_stats() const
+{
+    std::lock_guard<std::mutex> lock(progress_mutex);
+    return reloads;
+}
+
+void AssetManager::publish(const std::function<void(Assets&)>& edit)
+{
+    std::lock_guard<std::mutex> lock(publish_mutex);
+
+    auto next = std::make_shared<Assets>(*assets.load(std::memory_order_relaxed));
+    edit(*next);
+
+    assets.store(std::move(next), std::memory_order_release);
+}
+
+void AssetManager::complete(bool ok)
+{
+    std::lock_guard<std::mutex> lock(progress_mutex);
+
+    if (ok)
+        status.loaded++;
+    else
+        status.failed++;
+
+    finished.notify_all();
+}
+
+// A failed decode keeps whatever was published before, the placeholder or the old asset.
+bool AssetManager::decode_texture(const std::string& name, int handle, uint64_t id,
+                                  bool& published)
+{
+    published = false;
+
+    auto texture = std::make_shared<Texture>();
+    if (!texture->load(name)) return false;
+
+    publish(
+        [&](Assets& next)
+        {
+            published = latest_serial[name] == id;
+            if (published) next.textures[handle] = std::move(texture);
+        });
+
+    return true;
+}
+
+bool AssetManager::decode_level(const std::string& name, uint64_t id, bool& published)
+{
+    published = false;
+
+    auto level = std::make_shared<Level>(0, 0);
+    if (!level->load(name)) return false;
+
+    publish(
+        [&](Assets& next)
+        {
+            published = latest_serial[name] == id;
+            if (published) next.level = std::move(level);
+        });
+
+    return true;
+}
+
+uint64_t AssetManager::next_serial(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(publish_mutex);
+    return latest_serial[name] = ++serial;
+}
+
+void AssetManager::record_reload(const std::string& name,
+                                 std::chrono::steady_clock::time_point changed)
+{
+    const std::chrono::duration<double, std::milli> latency =
+        std::chrono::steady_clock::now() - changed;
+
+    {
+        std::lock_guard<std::mutex> lock(progress_mutex);
+        reloads.reloads++;
+        reloads.last_ms = latency.count();
+        reloads.max_ms = std::max(reloads.max_ms, latency.count());
+    }
+
+    std::cerr << "Reloaded " << name << " in " << latency.count() << " ms" << std::endl;
+}
+}  // namespace Engine
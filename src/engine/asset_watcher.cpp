@@ -0,0 +1,94 @@
+#include "engine/asset_watcher.h"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <set>
+#include <string>
+
+namespace Engine
+{
+AssetWatcher::AssetWatcher(AssetManager& _manager, int _inotify_fd, int _stop_fd,
+                           int _textures_wd, int _levels_wd)
+    : manager(_manager),
+      inotify_fd(_inotify_fd),
+      stop_fd(_stop_fd),
+      textures_wd(_textures_wd),
+      levels_wd(_levels_wd)
+{
+    watcher = std::thread(&AssetWatcher::work, this);
+}
+
+AssetWatcher::~AssetWatcher()
+{
+    const uint64_t one = 1;
+    if (write(stop_fd, &one, sizeof(one)) != sizeof(one)) std::terminate();
+
+    watcher.join();
+
+    close(inotify_fd);
+    close(stop_fd);
+}
+
+std::unique_ptr<AssetWatcher> AssetWatcher::start(AssetManager& manager)
+{
+    const int inotify_fd = inotify_init1(IN_CLOEXEC);
+    if (inotify_fd < 0) return nullptr;
+
+    // Editors either rewrite a file in place or move a new one over it.
+    constexpr uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO;
+    const int textures_wd = inotify_add_watch(inotify_fd, "data/textures", mask);
+    const int levels_wd = inotify_add_watch(inotify_fd, "data/levels", mask);
+    const int stop_fd = eventfd(0, EFD_CLOEXEC);
+
+    if (textures_wd < 0 || levels_wd < 0 || stop_fd < 0)
+    {
+        close(inotify_fd);
+        if (stop_fd >= 0) close(stop_fd);
+
+        return nullptr;
+    }
+
+    return std::unique_ptr<AssetWatcher>(
+        new AssetWatcher(manager, inotify_fd, stop_fd, textures_wd, levels_wd));
+}
+
+void AssetWatcher::work()
+{
+    alignas(inotify_event) char buffer[4096];
+    pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {stop_fd, POLLIN, 0}};
+
+    while (true)
+    {
+        if (poll(fds, 2, -1) < 0) continue;
+        if (fds[1].revents & POLLIN) return;
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        const ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+        if (length <= 0) continue;
+
+        const auto changed = std::chrono::steady_clock::now();
+
+        // A single save often produces several events, reload each file once.
+        std::set<std::pair<int, std::string>> files;
+        for (ssize_t i = 0; i < length;)
+        {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + i);
+            if (event->len > 0) files.emplace(event->wd, event->name);
+
+            i += sizeof(inotify_event) + event->len;
+        }
+
+        for (const auto& [wd, name] : files)
+        {
+            if (wd == textures_wd)
+                manager.reload_texture(name, changed);
+            else if (wd == levels_wd)
+                manager.reload_level(name, changed);
+        }
+    }
+}
+}  // namespace Engine
@@ -0,0 +1,104 @@
+#include "engine/context.h"
+
+#include <algorithm>
+
+namespace Engine
+{
+void EngineContext::update_assets(std::shared_ptr<const Assets> latest)
+{
+    if (latest->level && latest->level != assets->level)
+    {
+        const unsigned generation = game.level.generation;
+
+        game.level = *latest->level;
+        game.level.generation = generation + 1;
+        game.keep_player_in_level();
+        update_lighting();
+    }
+
+    assets = std::move(latest);
+}
+
+void EngineContext::enable_rewind(size_t max_ticks, size_t max_bytes)
+{
+    rewind = std::make_unique<RewindBuffer>(max_ticks, max_bytes);
+}
+
+void EngineContext::step(double dt)
+{
+    delta_time = dt;
+
+    if (rewind) rewind_time += std::min(dt, MAX_REWIND_STEP);
+
+    if (rewind && rewinding)
+    {
+        for (; rewind_time >= REWIND_INTERVAL; rewind_time -= REWIND_INTERVAL)
+            if (rewind_position + 1 < rewind->ticks()) rewind_position++;
+
+        rewind->seek(game, rewind_position);
+        game.update_sight();
+        update_lighting();
+
+        return;
+    }
+
+    if (rewind && rewind_position > 0)
+    {
+        rewind->truncate(rewind_position);
+        rewind_position = 0;
+    }
+
+    game.keys_handler(dt);
+    game.update_sight();
+
+    // A frame slower than the interval records its state for every interval it took.
+    if (rewind)
+        for (; rewind_time >= REWIND_INTERVAL; rewind_time -= REWIND_INTERVAL) rewind->record(game);
+
+    update_lighting();
+}
+
+void EngineContext::render()
+{
+    // A snapshot loaded between steps may have brought other cells along.
+    if (!lightmap.matches(game.level)) update_lighting();
+
+    const Camera camera{game.player.x, game.player.y, game.player.angle};
+    render_view(game.level, assets->textures, camera, frame.pixels, frame.depth, &lightmap);
+}
+
+void EngineContext::toggle_torch()
+{
+    Light light = lightmap.light(torch);
+    light.x = game.player.x;
+    light.y = game.player.y;
+    light.on = !light.on;
+
+    lightmap.set_light(game.level, torch, light);
+}
+
+void EngineContext::update_lighting()
+{
+    if (!lightmap.matches(game.level)) lightmap.bake(game.level);
+
+    // Only a torch that moved relights anything.
+    Light light = lightmap.light(torch);
+    if (light.on && (light.x != game.player.x || light.y != game.player.y))
+    {
+        light.x = game.player.x;
+        light.y = game.player.y;
+        lightmap.set_light(game.level, torch, light);
+    }
+}
+
+void tick_contexts(std::span<const std::unique_ptr<EngineContext>> contexts, double dt,
+                   ThreadPool& pool)
+{
+    pool.parallel_for(contexts.size(),
+                      [&](int i)
+                      {
+                          contexts[i]->step(dt);
+                          contexts[i]->render();
+                      });
+}
+}  // namespace Engine
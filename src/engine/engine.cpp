@@ -3,7 +3,6 @@
 #include <GL/freeglut.h>
 #include <GL/freeglut_ext.h>
 
-#include <cstring>
 #include <iostream>
 
 namespace Engine
@@ -35,28 +34,20 @@ void render_crosshair()
 
 void render_enemies()
 {
-    const double theta = degrees_to_radians(game.player.angle);
-
-    double rx, ry;
-    double sx, sy;
+    const Game& game = context.game;
+    const Camera camera{game.player.x, game.player.y, game.player.angle};
+    const double theta = degrees_to_radians(camera.angle);
+    const double cos_theta = cos(theta);
+    const double sin_theta = sin(theta);
 
     for (const auto& enemy : game.enemies)
     {
-        // Enemy position relative to player
-        rx = enemy->x - game.player.x;
-        ry = enemy->y - game.player.y;
-
-        // Transformation matrix to compute world space coordinates
-        double a = cos(theta) * ry + sin(theta) * rx;
-        double b = -sin(theta) * ry + cos(theta) * rx;
+        const SpriteProjection projection =
+            project_sprite(camera, cos_theta, sin_theta, enemy->x, enemy->y, enemy->z);
 
-        // Transform world coordinates to screen space
-        sx = (a * 108.0 / b) + (120 / 2);
-        sy = (enemy->z * 108.0 / b) + (80 / 2);
-
-        int scale = 32 * 80 / b;
-        scale = std::max(0, scale);
-        scale = std::min(120, scale);
+        const double sx = projection.sx;
+        const double sy = projection.sy;
+        const int scale = projection.scale;
 
         glPointSize(8);
         glBegin(GL_POINTS);
@@ -64,7 +55,7 @@ void render_enemies()
         double tx = 0, ty = 31;
         double tx_step = 32.0 / scale, ty_step = 32.0 / scale;
 
-        if (sx > 0 && sx < 120 && b < depth_buffer[static_cast<int>(sx)])
+        if (sx > 0 && sx < 120 && projection.depth < context.frame.depth[static_cast<int>(sx)])
         {
             for (int x = sx - scale / 2; x < sx + scale / 2; ++x)
             {
@@ -72,9 +63,9 @@ void render_enemies()
                 for (int y = 0; y < scale; ++y)
                 {
                     int pixel = (static_cast<int>(ty) * 32 + static_cast<int>(tx)) * 3;
-                    int r = textures[1][pixel];
-                    int g = textures[1][pixel + 1];
-                    int b = textures[1][pixel + 2];
+                    int r = (*context.assets->textures[1])[pixel];
+                    int g = (*context.assets->textures[1])[pixel + 1];
+                    int b = (*context.assets->textures[1])[pixel + 2];
 
                     if (r != 255 && g != 0 && b != 255)
                     {
@@ -104,271 +95,119 @@ void render_floor()
     glEnd();
 }
 
-/*
- * Register vertical hits:
- *  - First we calculate if the ray points to the left or right,
- *    and we set the vertical ray and the offset multiplier accordingly.
- *  - Then we search for the first wall that the vertical ray hits, with
- *    an upper bound of depth.
- */
-double calculate_vertical_hits(double theta, double tangent, double& vx, double& vy, int& vmt)
+void render_scene()
 {
-    const double py = game.player.y;
-    const double px = game.player.x;
-
-    double d_vertical = INFINITY;
-    double ox, oy;
-
-    if (cos(theta) > EPSILON)  // Points left
-    {
-        vx = ((static_cast<int>(px) >> 6) << 6) + 64;
-        vy = (px - vx) * tangent + py;
-
-        ox = 64;
-        oy = -64 * tangent;
-    }
-    else if (cos(theta) < -EPSILON)  // Points right
-    {
-        vx = ((static_cast<int>(px) >> 6) << 6) - EPSILON;
-        vy = (px - vx) * tangent + py;
-
-        ox = -64;
-        oy = 64 * tangent;
-    }
-    else  // Points straight up or down, no hit
-    {
-        vx = px;
-        vy = py;
+    context.render();
 
-        return d_vertical;
-    }
+    glutPostRedisplay();
+}
 
-    for (int depth = 0; depth < MAX_DEPTH; ++depth)
-    {
-        // Calculate Position relative to the grid and see if there is a hit.
-        int pos = (static_cast<int>(vy) >> 6) * game.level.width + (static_cast<int>(vx) >> 6);
-        bool hit = pos > 0 && pos < game.level.width * game.level.height && game.level[pos] > 0;
-        if (hit)
-        {
-            vmt = game.level[pos] - 1;
-            d_vertical = cos(theta) * (vx - px) - sin(theta) * (vy - py);
+///////////////////////////////////////////////////////////////////////////////
+// INPUT
+///////////////////////////////////////////////////////////////////////////////
 
-            break;
-        }
+// The pointer position at the last motion event, and when the pending warp to the center was made.
+static int pointer_x = SCREEN_WIDTH / 2;
+static bool warping = false;
+static int warp_time = 0;
 
-        vx += ox;
-        vy += oy;
-    }
+///////////////////////////////////////////////////////////////////////////////
+// GLUT HOOKS
+///////////////////////////////////////////////////////////////////////////////
 
-    return d_vertical;
+void button_down(unsigned char key, int x, int y)
+{
+    input.push({InputType::KEY_DOWN, key});
 }
 
-/*
- * Register horizontal hits:
- *  - First we calculate if the ray points to the up or down,
- *    and we set the horizontal ray and the offset multiplier accordingly.
- *  - Then we search for the first wall that the horizontal ray hits, with
- *    an upper bound of depth.
- */
-double calculate_horizontal_hits(double theta, double tangent, double& hx, double& hy, int& hmt)
+void button_up(unsigned char key, int x, int y)
 {
-    tangent = 1.0 / tangent;
-
-    const double py = game.player.y;
-    const double px = game.player.x;
-
-    double d_horizontal = INFINITY;
-    double ox, oy;
-
-    if (sin(theta) > EPSILON)  // Points up
-    {
-        hy = ((static_cast<int>(py) >> 6) << 6) - EPSILON;
-        hx = (py - hy) * tangent + px;
-
-        ox = 64 * tangent;
-        oy = -64;
-    }
-    else if (sin(theta) < -EPSILON)  // Points down
-    {
-        hy = ((static_cast<int>(py) >> 6) << 6) + 64;
-        hx = (py - hy) * tangent + px;
-
-        ox = -64 * tangent;
-        oy = 64;
-    }
-    else  // Points straight left or right, no hit
-    {
-        hx = px;
-        hy = py;
-
-        return d_horizontal;
-    }
-
-    for (int depth = 0; depth < MAX_DEPTH; ++depth)
-    {
-        // Calculate Position relative to the grid and see if there is a hit.
-        int pos = (static_cast<int>(hy) >> 6) * game.level.width + (static_cast<int>(hx) >> 6);
-        bool hit = pos > 0 && pos < game.level.width * game.level.height && game.level[pos] > 0;
-        if (hit)
-        {
-            hmt = game.level[pos] - 1;
-            d_horizontal = cos(theta) * (hx - px) - sin(theta) * (hy - py);
-
-            break;
-        }
-
-        hx += ox;
-        hy += oy;
-    }
-
-    return d_horizontal;
+    input.push({InputType::KEY_UP, key});
 }
 
-void render_scene()
+void look(int x, int y)
 {
-    int vmt = 0, hmt = 0;
-
-    double pa = game.player.angle;
-    double r_angle = clamp_to_unit_circle(pa + 30);
-
-    // Vertical vector and horizontal vector representing a ray
-    double vx, vy;
-    double hx, hy;
-
-    // Reset pixel buffer
-    std::memset(pixel_buffer, 0, RENDER_WIDTH * RENDER_HEIGHT * 3 * sizeof(uint8_t));
+    constexpr int center_x = SCREEN_WIDTH / 2;
+    constexpr int center_y = SCREEN_HEIGHT / 2;
 
-    for (int ray = 0; ray < RENDER_WIDTH; ++ray)
+    /*
+     * The event caused by our own warp is not movement, it only moves the
+     * reference point to the center. It doesn't always land exactly there:
+     * the pointer may have moved on since, and only that part is counted.
+     * The events still on their way from before the warp are near the edge.
+     */
+    const int now = glutGet(GLUT_ELAPSED_TIME);
+    const bool landed =
+        std::abs(x - center_x) < center_x / 4 && std::abs(y - center_y) < center_y / 4;
+
+    if (warping && landed)
     {
-        double theta = degrees_to_radians(r_angle);
-        double tangent = tan(theta);
-
-        // These functions change the values of hx, vx, hmt, vx, vy, vmt.
-        double d_horizontal = calculate_horizontal_hits(theta, tangent, hx, vx, hmt);
-        double d_vertical = calculate_vertical_hits(theta, tangent, vx, vy, vmt);
-        double shade = 1;
-
-        /*
-         * We take the ray with the shortest distance to draw the scene.
-         * To create the illusion of shadows, we use a different color
-         * for vertical hits and horizontal hits.
-         */
-        if (d_vertical < d_horizontal)
-        {
-            hx = vx;
-            hy = vy;
-            d_horizontal = d_vertical;
-            hmt = vmt;
-        }
-        else
-            shade = 0.5;
-
-        d_horizontal *= cos(degrees_to_radians(clamp_to_unit_circle(pa - r_angle)));
-        depth_buffer[ray] = d_horizontal;
-
-        int wall_height = (64 * RENDER_HEIGHT) / d_horizontal;
-
-        double ty_step = 64.0 / static_cast<double>(wall_height);
-        double ty_offset = 0;
-
-        if (wall_height > RENDER_HEIGHT)
-        {
-            ty_offset = (wall_height - RENDER_HEIGHT) / 2;
-            wall_height = RENDER_HEIGHT;
-        }
-
-        int offset = (RENDER_HEIGHT / 2) - (wall_height >> 1);
-
-        double tx;
-        double ty = ty_offset * ty_step;
-
-        if (shade == 1)
-        {
-            tx = static_cast<int>(hy) % 64;
-            if (game.player.angle > 90 && game.player.angle < 270) tx = 63 - tx;
-        }
-        else
-        {
-            tx = static_cast<int>(hx) % 64;
-            if (game.player.angle > 180) tx = 63 - tx;
-        }
+        warping = false;
+        pointer_x = center_x;
+    }
+    else if (warping && now - warp_time > WARP_TIMEOUT)
+        warping = false;
 
-        // walls
-        for (int y = 0; y < wall_height; ++y)
-        {
-            const int pixel = (static_cast<int>(ty) * 64 + static_cast<int>(tx));
-            const uint32_t color = textures[hmt][pixel];
+    const int delta_x = x - pointer_x;
+    pointer_x = x;
 
-            const uint8_t r = color >> 16;
-            const uint8_t g = (color >> 8) & 0xFF;
-            const uint8_t b = color & 0xFF;
+    if (delta_x != 0) input.push({InputType::MOTION, 0, delta_x});
 
-            if (r > 0 || g > 0 || b > 0)
-            {
-                int pixel_pointer = ((y + offset) * (RENDER_WIDTH) + ray) * 3;
-                pixel_buffer[pixel_pointer++] = r;
-                pixel_buffer[pixel_pointer++] = g;
-                pixel_buffer[pixel_pointer++] = b;
-            }
+    // Only recenter once the pointer gets near the edge, so most events cause no warp at all.
+    const bool near_edge =
+        std::abs(x - center_x) > center_x / 2 || std::abs(y - center_y) > center_y / 2;
 
-            ty += ty_step;
-        }
-
-        r_angle = clamp_to_unit_circle(r_angle - 60.0 / RENDER_WIDTH);
+    if (!warping && near_edge)
+    {
+        warping = true;
+        warp_time = now;
+        glutWarpPointer(center_x, center_y);
     }
-
-    glutPostRedisplay();
 }
 
-///////////////////////////////////////////////////////////////////////////////
-// GLUT HOOKS
-///////////////////////////////////////////////////////////////////////////////
-
-void button_down(unsigned char key, int x, int y)
+/*
+ * Takes all input since the previous tick at once and applies it to the
+ * context: held keys set the movement, presses trigger their action once,
+ * and the pointer movement is applied as a single turn.
+ */
+void sample_input()
 {
-    switch (key)
-    {
-        case 'w': Engine::game.keys.w = true; break;
-        case 'a': Engine::game.keys.a = true; break;
-        case 's': Engine::game.keys.s = true; break;
-        case 'd': Engine::game.keys.d = true; break;
-        case 27:
-        {
-            glutDestroyWindow(window_id);
-            exit(0);
-        }
-        break;
-    }
+    const InputSample sample = input.sample();
 
-    glutPostRedisplay();
-}
+    context.game.keys.w = sample.held['w'];
+    context.game.keys.a = sample.held['a'];
+    context.game.keys.s = sample.held['s'];
+    context.game.keys.d = sample.held['d'];
+    context.rewinding = sample.held['r'];
 
-void button_up(unsigned char key, int x, int y)
-{
-    switch (key)
+    if (sample.pressed['k']) save_snapshot_file(QUICKSAVE, context.game);
+    if (sample.pressed['l']) load_snapshot_file(QUICKSAVE, context.game);
+    if (sample.pressed['f']) context.toggle_torch();
+
+    if (sample.pressed[27])
     {
-        case 'w': game.keys.w = false; break;
-        case 'a': game.keys.a = false; break;
-        case 's': game.keys.s = false; break;
-        case 'd': game.keys.d = false; break;
+        glutDestroyWindow(window_id);
+        exit(0);
     }
 
-    glutPostRedisplay();
+    context.game.mouse_look(sample.look_dx);
 }
 
-void look(int x, int y)
+/*
+ * display runs as fast as it can, so frames are paced to RECORD_FPS here:
+ * the latest frame stands in for every interval that has passed, repeated
+ * when the game runs slower and skipped when faster. It is submitted once,
+ * with the number of intervals as its repeat count.
+ */
+void record_frame()
 {
-    constexpr int center_x = SCREEN_WIDTH / 2;
-    constexpr int center_y = SCREEN_HEIGHT / 2;
+    const double interval = 1000.0 / RECORD_FPS;
+    if (next_record_time < 0) next_record_time = context.time_since_frame;
 
-    // Ensures that the mouse stays centered
-    if (x != center_x || y != center_y) glutWarpPointer(center_x, center_y);
+    int repeat = 0;
+    for (; next_record_time <= context.time_since_frame; next_record_time += interval) repeat++;
 
-    // Alter the player's look angle based on mouse x movement
-    int delta_x = x - center_x;
-    game.mouse_look(delta_x, delta_time);
-
-    glutPostRedisplay();
+    if (repeat > 0) frame_sink->submit(context.frame.pixels, repeat);
 }
 
 void load_texture()
@@ -384,7 +223,7 @@ void load_texture()
 
     // Load the pixel data into the texture
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, RENDER_WIDTH, RENDER_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE,
-                 pixel_buffer);
+                 context.frame.pixels.data());
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
@@ -412,18 +251,36 @@ void display()
 {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    // Pick up assets that finished loading since the last frame.
+    context.update_assets(asset_manager.current());
+
+    // Update delta time to get consistent game speed
+    context.time_since_frame = glutGet(GLUT_ELAPSED_TIME);
+    const double delta_time = context.time_since_frame - context.old_time_since_frame;
+    context.old_time_since_frame = context.time_since_frame;
+
+    // Step before rendering, so the frame shown already reflects the latest input.
+    sample_input();
+    context.step(delta_time);
+
     render_scene();
+    if (frame_sink) record_frame();
+
     load_texture();
     render_texture();
 
-    // Update delta time to get consistent game speed
-    time_since_frame = glutGet(GLUT_ELAPSED_TIME);
-    delta_time = time_since_frame - old_time_since_frame;
-    old_time_since_frame = time_since_frame;
-    game.keys_handler(delta_time);
-
     int fps = static_cast<int>(1000.0 / delta_time);
-    const unsigned char* t = reinterpret_cast<const unsigned char*>(std::to_string(fps).c_str());
+    std::string status = std::to_string(fps);
+
+    const LoadProgress progress = asset_manager.progress();
+    if (progress.loaded + progress.failed < progress.total)
+        status += " loading " + std::to_string(progress.loaded) + "/" +
+                  std::to_string(progress.total);
+
+    const ReloadStats reloads = asset_manager.reload_stats();
+    if (reloads.reloads > 0) status += " reload " + std::to_string(reloads.last_ms) + " ms";
+
+    const unsigned char* t = reinterpret_cast<const unsigned char*>(status.c_str());
     glRasterPos2i(0, 0);
     glutBitmapString(GLUT_BITMAP_HELVETICA_18, t);
 
@@ -446,6 +303,9 @@ void initialize(int argc, char* argv[])
     glutDisplayFunc(display);
     glutKeyboardFunc(button_down);
     glutKeyboardUpFunc(button_up);
+    glutMotionFunc(look);
+    glutPassiveMotionFunc(look);
+    glutIgnoreKeyRepeat(1);
 
     glutMainLoop();
 }
@@ -0,0 +1,262 @@
+#include "engine/frame_sink.h"
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+
+namespace Engine
+{
+/*
+ * Writes all buffers in iov, retrying on partial writes and splitting
+ * batches that are larger than IOV_MAX. The iovecs are consumed.
+ */
+static bool write_all(int fd, std::vector<iovec>& iov)
+{
+    size_t index = 0;
+
+    while (index < iov.size())
+    {
+        const int count = std::min<size_t>(iov.size() - index, IOV_MAX);
+        ssize_t n = writev(fd, iov.data() + index, count);
+
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+
+        while (index < iov.size() && static_cast<size_t>(n) >= iov[index].iov_len)
+        {
+            n -= iov[index].iov_len;
+            index++;
+        }
+
+        if (n > 0)
+        {
+            iov[index].iov_base = static_cast<uint8_t*>(iov[index].iov_base) + n;
+            iov[index].iov_len -= n;
+        }
+    }
+
+    return true;
+}
+
+FrameSink::FrameSink(int _fd, FrameFormat _format, int _width, int _height, int _fps,
+                     int capacity)
+    : fd(_fd),
+      format(_format),
+      width(_width),
+      height(_height),
+      fps(_fps),
+      frame_size(_width * _height * 3)
+{
+    if (format == FrameFormat::PPM)
+        frame_header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    else if (format == FrameFormat::Y4M)
+        frame_header = "FRAME\n";
+
+    ring.assign(capacity, std::vector<uint8_t>(frame_size));
+    repeats.assign(capacity, 1);
+    if (format == FrameFormat::Y4M) planes.assign(capacity, std::vector<uint8_t>(frame_size));
+
+    // A reader closing the pipe should stop the recording, not kill the game.
+    std::signal(SIGPIPE, SIG_IGN);
+
+    writer = std::thread(&FrameSink::work, this);
+}
+
+FrameSink::~FrameSink()
+{
+    stopping.store(true, std::memory_order_release);
+    signal.fetch_add(1, std::memory_order_release);
+    signal.notify_one();
+    writer.join();
+
+    if (fd > STDERR_FILENO) close(fd);
+
+    const FrameSinkStats s = stats();
+    std::cerr << "Recorded " << s.written << " frames, dropped " << s.dropped << ", "
+              << s.bytes / 1e6 << " MB at " << (s.seconds > 0 ? s.bytes / 1e6 / s.seconds : 0)
+              << " MB/s" << std::endl;
+}
+
+std::unique_ptr<FrameSink> FrameSink::open(const std::string& path, FrameFormat format,
+                                           int width, int height, int fps)
+{
+    int fd = STDOUT_FILENO;
+
+    if (path != "-")
+    {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return nullptr;
+    }
+
+    return std::make_unique<FrameSink>(fd, format, width, height, fps);
+}
+
+FrameFormat FrameSink::format_from_path(const std::string& path)
+{
+    if (path.ends_with(".ppm")) return FrameFormat::PPM;
+    if (path.ends_with(".y4m")) return FrameFormat::Y4M;
+
+    return FrameFormat::RAW;
+}
+
+bool FrameSink::submit(std::span<const uint8_t> pixels, int repeat)
+{
+    if (repeat <= 0) return false;
+
+    submitted.fetch_add(repeat, std::memory_order_relaxed);
+
+    const uint64_t h = head.load(std::memory_order_relaxed);
+    const bool full = h - tail.load(std::memory_order_acquire) >= ring.size();
+
+    if (full || failed.load(std::memory_order_relaxed) || pixels.size() != frame_size)
+    {
+        dropped.fetch_add(repeat, std::memory_order_relaxed);
+        return false;
+    }
+
+    std::memcpy(ring[h % ring.size()].data(), pixels.data(), frame_size);
+    repeats[h % ring.size()] = repeat;
+    head.store(h + 1, std::memory_order_release);
+
+    signal.fetch_add(1, std::memory_order_release);
+    signal.notify_one();
+
+    return true;
+}
+
+FrameSinkStats FrameSink::stats() const
+{
+    FrameSinkStats s;
+    s.submitted = submitted.load(std::memory_order_relaxed);
+    s.written = written.load(std::memory_order_relaxed);
+    s.dropped = dropped.load(std::memory_order_relaxed);
+    s.bytes = bytes.load(std::memory_order_relaxed);
+    s.seconds = nanoseconds.load(std::memory_order_relaxed) / 1e9;
+
+    return s;
+}
+
+void FrameSink::write_stream_header()
+{
+    std::string header = "YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height) +
+                         " F" + std::to_string(fps) + ":1 Ip A1:1 C444\n";
+
+    std::vector<iovec> iov{{header.data(), header.size()}};
+    if (!write_all(fd, iov)) failed.store(true, std::memory_order_relaxed);
+}
+
+/*
+ * Writes the frames in slots [first, last) with as few syscalls as possible.
+ * Raw and PPM frames are written straight from the ring, Y4M frames are
+ * converted into their slot's planes first. A repeated frame is the same
+ * buffer written again.
+ */
+bool FrameSink::write_frames(uint64_t first, uint64_t last)
+{
+    std::vector<iovec> iov;
+    iov.reserve((last - first) * 2);
+
+    size_t size = 0;
+    uint64_t frames = 0;
+
+    for (uint64_t i = first; i < last; ++i)
+    {
+        const size_t slot = i % ring.size();
+
+        uint8_t* data = ring[slot].data();
+        if (format == FrameFormat::Y4M)
+        {
+            convert_to_yuv(ring[slot], planes[slot]);
+            data = planes[slot].data();
+        }
+
+        for (int r = 0; r < repeats[slot]; ++r)
+        {
+            if (!frame_header.empty())
+            {
+                iov.push_back({frame_header.data(), frame_header.size()});
+                size += frame_header.size();
+            }
+
+            iov.push_back({data, frame_size});
+            size += frame_size;
+        }
+
+        frames += repeats[slot];
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const bool ok = write_all(fd, iov);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    nanoseconds.fetch_add(std::chrono::nanoseconds(elapsed).count(), std::memory_order_relaxed);
+
+    if (ok)
+    {
+        written.fetch_add(frames, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    return ok;
+}
+
+// BT.601 studio swing conversion, written as Y, U and V planes.
+void FrameSink::convert_to_yuv(const std::vector<uint8_t>& rgb, std::vector<uint8_t>& yuv) const
+{
+    const int plane = width * height;
+
+    for (int i = 0; i < plane; ++i)
+    {
+        const int r = rgb[i * 3];
+        const int g = rgb[i * 3 + 1];
+        const int b = rgb[i * 3 + 2];
+
+        yuv[i] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+        yuv[plane + i] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+        yuv[plane * 2 + i] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+    }
+}
+
+void FrameSink::work()
+{
+    if (format == FrameFormat::Y4M) write_stream_header();
+
+    uint64_t t = tail.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        // Load the signal before head, so a submit in between wakes the wait.
+        const uint32_t s = signal.load(std::memory_order_acquire);
+        const uint64_t h = head.load(std::memory_order_acquire);
+
+        if (h == t)
+        {
+            if (stopping.load(std::memory_order_acquire)) return;
+
+            signal.wait(s, std::memory_order_acquire);
+            continue;
+        }
+
+        if (failed.load(std::memory_order_relaxed) || !write_frames(t, h))
+        {
+            if (!failed.exchange(true, std::memory_order_relaxed))
+                std::cerr << "Stopped recording: " << std::strerror(errno) << std::endl;
+
+            for (uint64_t i = t; i < h; ++i)
+                dropped.fetch_add(repeats[i % ring.size()], std::memory_order_relaxed);
+        }
+
+        t = h;
+        tail.store(t, std::memory_order_release);
+    }
+}
+}  // namespace Engine
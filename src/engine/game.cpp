@@ -2,14 +2,25 @@
 
 namespace Engine
 {
-void Game::mouse_look(int dx, double dt)
+void Game::mouse_look(double dx)
 {
-    int d_angle = 0;
+    player.angle = clamp_to_unit_circle(player.angle - dx * MOUSE_SENSITIVITY);
+}
 
-    if (dx > 0) d_angle = std::max(1, static_cast<int>(dx / 25 * 0.2 * dt));
-    if (dx < 0) d_angle = std::min(-1, static_cast<int>(dx / 25 * 0.2 * dt));
+void Game::keep_player_in_level()
+{
+    if (!level.solid(std::floor(player.x / 64), std::floor(player.y / 64))) return;
 
-    player.angle = clamp_to_unit_circle(player.angle - d_angle);
+    for (int i = 0; i < level.width * level.height; ++i)
+    {
+        if (level[i] == 0)
+        {
+            player.x = (i % level.width) * 64 + 32;
+            player.y = (i / level.width) * 64 + 32;
+
+            return;
+        }
+    }
 }
 
 void Engine::Game::keys_handler(double dt)
@@ -20,25 +31,25 @@ void Engine::Game::keys_handler(double dt)
     const int ox = (dx < 0) ? -10 : 10;
     const int oy = (dy < 0) ? -10 : 10;
 
-    const int mx = player.x / 64.0;
-    const int my = player.y / 64.0;
+    const int mx = std::floor(player.x / 64.0);
+    const int my = std::floor(player.y / 64.0);
 
     if (keys.w)
     {
-        int ipx_po = (player.x + ox) / 64.0;
-        int ipy_po = (player.y + oy) / 64.0;
+        int ipx_po = std::floor((player.x + ox) / 64.0);
+        int ipy_po = std::floor((player.y + oy) / 64.0);
 
-        if (level[my * MAP_WIDTH + ipx_po] == 0) player.x += 0.2 * dt * dx;
-        if (level[ipy_po * MAP_WIDTH + mx] == 0) player.y += 0.2 * dt * dy;
+        if (!level.solid(ipx_po, my)) player.x += 0.2 * dt * dx;
+        if (!level.solid(mx, ipy_po)) player.y += 0.2 * dt * dy;
     }
 
     if (keys.s)
     {
-        int ipx_no = (player.x - ox) / 64.0;
-        int ipy_no = (player.y - oy) / 64.0;
+        int ipx_no = std::floor((player.x - ox) / 64.0);
+        int ipy_no = std::floor((player.y - oy) / 64.0);
 
-        if (level[my * MAP_WIDTH + ipx_no] == 0) player.x -= 0.2 * dt * dx;
-        if (level[ipy_no * MAP_WIDTH + mx] == 0) player.y -= 0.2 * dt * dy;
+        if (!level.solid(ipx_no, my)) player.x -= 0.2 * dt * dx;
+        if (!level.solid(mx, ipy_no)) player.y -= 0.2 * dt * dy;
     }
 
     if (keys.a)
@@ -51,4 +62,13 @@ void Engine::Game::keys_handler(double dt)
         player.angle = clamp_to_unit_circle(player.angle - dt / 6);
     }
 }
+
+void Game::update_sight()
+{
+    for (const auto& enemy : enemies)
+    {
+        const Segment sight{enemy->x, enemy->y, player.x, player.y};
+        enemy->sees_player = line_of_sight(level, sight);
+    }
+}
 }  // namespace Engine
\ No newline at end of file
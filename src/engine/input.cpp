@@ -0,0 +1,42 @@
+#include "engine/input.h"
+
+namespace Engine
+{
+void InputQueue::push(const InputEvent& event)
+{
+    std::atomic<uint64_t>& held_word = held[event.key / 64];
+    const uint64_t bit = uint64_t{1} << (event.key % 64);
+
+    switch (event.type)
+    {
+        case InputType::KEY_DOWN:
+            // Key repeat sends more downs for a held key, those are not presses.
+            if (!(held_word.fetch_or(bit, std::memory_order_relaxed) & bit))
+                pressed[event.key / 64].fetch_or(bit, std::memory_order_release);
+            break;
+        case InputType::KEY_UP: held_word.fetch_and(~bit, std::memory_order_release); break;
+        case InputType::MOTION: look_dx.fetch_add(event.dx, std::memory_order_relaxed); break;
+    }
+}
+
+InputSample InputQueue::sample()
+{
+    InputSample sample;
+
+    for (int word = 0; word < 4; ++word)
+    {
+        const uint64_t down = pressed[word].exchange(0, std::memory_order_acquire);
+        const uint64_t up = held[word].load(std::memory_order_acquire);
+
+        for (int bit = 0; bit < 64; ++bit)
+        {
+            sample.pressed[word * 64 + bit] = (down >> bit) & 1;
+            sample.held[word * 64 + bit] = (up >> bit) & 1;
+        }
+    }
+
+    sample.look_dx = look_dx.exchange(0, std::memory_order_relaxed);
+
+    return sample;
+}
+}  // namespace Engine
@@ -1,5 +1,9 @@
 #include "engine/level.h"
 
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
 namespace Engine
 {
 int Level::operator[](int i) const
@@ -12,6 +16,70 @@ int& Level::operator[](int i)
     return data[i];
 }
 
+bool Level::solid(int cx, int cy) const
+{
+    if (cx < 0 || cx >= width || cy < 0 || cy >= height) return true;
+
+    return data[cy * width + cx] > 0;
+}
+
+bool Level::valid_cell(int value)
+{
+    return value >= 0 && value <= WALL_TEXTURES;
+}
+
+bool Level::load(std::string name)
+{
+    std::ifstream file("data/levels/" + name);
+    int w, h;
+
+    if (!(file >> w >> h) || w <= 0 || h <= 0)
+    {
+        std::cout << "Problem loading " + name + ": bad dimensions" << std::endl;
+        return false;
+    }
+
+    std::vector<int> cells(w * h);
+    for (int& cell : cells)
+    {
+        if (!(file >> cell) || !valid_cell(cell))
+        {
+            std::cout << "Problem loading " + name + ": bad cell data" << std::endl;
+            return false;
+        }
+    }
+
+    // The lights are optional, the file may end after the cells.
+    std::vector<Light> static_lights;
+    int count;
+
+    if (file >> count)
+    {
+        static_lights.resize(std::max(0, count));
+
+        for (Light& light : static_lights)
+        {
+            if (!(file >> light.x >> light.y >> light.radius >> light.intensity) ||
+                light.radius <= 0)
+            {
+                std::cout << "Problem loading " + name + ": bad light data" << std::endl;
+                return false;
+            }
+
+            light.x *= 64;
+            light.y *= 64;
+            light.radius *= 64;
+        }
+    }
+
+    width = w;
+    height = h;
+    data = std::move(cells);
+    lights = std::move(static_lights);
+
+    return true;
+}
+
 // Initializes a level with borders (1's) and inside a big empty space (0's).
 void Level::initialize()
 {
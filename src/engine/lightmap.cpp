@@ -0,0 +1,170 @@
+#include "engine/lightmap.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "engine/query.h"
+
+namespace Engine
+{
+///////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DECLARATIONS
+///////////////////////////////////////////////////////////////////////////////
+
+// Per face: the offset to the neighbouring cell, which is also the face normal.
+const int FACE_X[4] = {0, 1, 0, -1};
+const int FACE_Y[4] = {-1, 0, 1, 0};
+
+///////////////////////////////////////////////////////////////////////////////
+// LIGHT PROPAGATION
+///////////////////////////////////////////////////////////////////////////////
+
+// A face can only be lit or seen when the cell in front of it is open.
+static bool exposed(const Level& level, int cx, int cy, int face)
+{
+    const int nx = cx + FACE_X[face];
+    const int ny = cy + FACE_Y[face];
+
+    return level[cy * level.width + cx] > 0 && nx >= 0 && nx < level.width && ny >= 0 &&
+           ny < level.height && level[ny * level.width + nx] == 0;
+}
+
+/*
+ * The light that reaches the middle of a face. The point is moved just off
+ * the wall into the open cell, so the line of sight ends before the wall
+ * the face belongs to.
+ */
+static double contribution(const Level& level, const Light& light, int cx, int cy, int face)
+{
+    const double px = cx * 64 + 32 + FACE_X[face] * 33;
+    const double py = cy * 64 + 32 + FACE_Y[face] * 33;
+
+    const double dx = light.x - px;
+    const double dy = light.y - py;
+    const double distance = std::hypot(dx, dy);
+    if (distance >= light.radius) return 0;
+
+    // Faces turned away from the light get nothing, the others by the angle they face it.
+    const double facing = (dx * FACE_X[face] + dy * FACE_Y[face]) / std::max(distance, 1.0);
+    if (facing <= 0) return 0;
+
+    if (!line_of_sight(level, {light.x, light.y, px, py})) return 0;
+
+    return light.intensity * (1 - distance / light.radius) * facing;
+}
+
+static uint8_t quantize(double brightness)
+{
+    return std::clamp<int>(std::lround(brightness * FULL_BRIGHT), 0, LIGHT_LEVELS - 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// LIGHTMAP
+///////////////////////////////////////////////////////////////////////////////
+
+void Lightmap::bake(const Level& level)
+{
+    width = level.width;
+    height = level.height;
+    generation = level.generation;
+
+    baked.assign(width * height * 4, 0);
+    levels.assign(width * height * 4, 0);
+
+    for (int cy = 0; cy < height; ++cy)
+    {
+        for (int cx = 0; cx < width; ++cx)
+        {
+            for (int face = NORTH; face <= WEST; ++face)
+            {
+                if (!exposed(level, cx, cy, face)) continue;
+
+                double brightness = (face == NORTH || face == SOUTH) ? AMBIENT_LIGHT / 2
+                                                                     : AMBIENT_LIGHT;
+                for (const Light& source : level.lights)
+                    brightness += contribution(level, source, cx, cy, face);
+
+                baked[(cy * width + cx) * 4 + face] = brightness;
+            }
+        }
+    }
+
+    relit_faces = 0;
+    relight(level, 0, 0, width - 1, height - 1);
+}
+
+bool Lightmap::matches(const Level& level) const
+{
+    return level.width == width && level.height == height && level.generation == generation;
+}
+
+int Lightmap::add_light(const Level& level, const Light& light)
+{
+    lights.push_back(light);
+
+    relit_faces = 0;
+    if (light.on) relight(level, light);
+
+    return lights.size() - 1;
+}
+
+void Lightmap::set_light(const Level& level, int id, const Light& light)
+{
+    const Light old = lights[id];
+    lights[id] = light;
+
+    relit_faces = 0;
+    if (old.on) relight(level, old);
+    if (light.on) relight(level, light);
+}
+
+const Light& Lightmap::light(int id) const
+{
+    return lights[id];
+}
+
+int Lightmap::relit() const
+{
+    return relit_faces;
+}
+
+// Relights the cells the light's radius touches.
+void Lightmap::relight(const Level& level, const Light& light)
+{
+    const int x0 = std::floor((light.x - light.radius) / 64);
+    const int y0 = std::floor((light.y - light.radius) / 64);
+    const int x1 = std::floor((light.x + light.radius) / 64);
+    const int y1 = std::floor((light.y + light.radius) / 64);
+
+    relight(level, x0, y0, x1, y1);
+}
+
+// Recomputes the level of every exposed face in the cells from (x0, y0) to (x1, y1).
+void Lightmap::relight(const Level& level, int x0, int y0, int x1, int y1)
+{
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, width - 1);
+    y1 = std::min(y1, height - 1);
+
+    for (int cy = y0; cy <= y1; ++cy)
+    {
+        for (int cx = x0; cx <= x1; ++cx)
+        {
+            for (int face = NORTH; face <= WEST; ++face)
+            {
+                if (!exposed(level, cx, cy, face)) continue;
+
+                const int i = (cy * width + cx) * 4 + face;
+                double brightness = baked[i];
+
+                for (const Light& source : lights)
+                    if (source.on) brightness += contribution(level, source, cx, cy, face);
+
+                levels[i] = quantize(brightness);
+                relit_faces++;
+            }
+        }
+    }
+}
+}  // namespace Engine
@@ -0,0 +1,280 @@
+#include "engine/query.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "engine/utility.h"
+
+namespace Engine
+{
+///////////////////////////////////////////////////////////////////////////////
+// GRID TRAVERSAL
+///////////////////////////////////////////////////////////////////////////////
+
+// The first wall on a walk through the grid, wall is -1 when there is none.
+struct GridHit
+{
+    double distance;
+    int wall;
+};
+
+// The wall at (cx, cy), 0 outside the level and -1 for an open cell.
+static int wall_at(const Level& level, int cx, int cy)
+{
+    if (cx < 0 || cx >= level.width || cy < 0 || cy >= level.height) return 0;
+
+    const int wall = level[cy * level.width + cx];
+    return (wall > 0) ? wall : -1;
+}
+
+/*
+ * Walks from (x, y) along the unit direction (dx, dy), visiting every cell
+ * the line crosses in order, and stops at the first wall or once
+ * max_distance is passed. The cell the walk starts in is not checked.
+ *
+ * The renderer's hit functions can't be reused for this: they search the
+ * vertical and the horizontal grid lines separately, and only return the
+ * nearest of both after walking each to its end.
+ * Their exact stepping also decides the pixels the oracle checks.
+ */
+static GridHit walk_grid(const Level& level, double x, double y, double dx, double dy,
+                         double max_distance)
+{
+    int cx = std::floor(x / 64);
+    int cy = std::floor(y / 64);
+    if (cx < 0 || cx >= level.width || cy < 0 || cy >= level.height) return {0, 0};
+
+    const int step_x = (dx < 0) ? -1 : 1;
+    const int step_y = (dy < 0) ? -1 : 1;
+
+    // Distance along the line to the next vertical and horizontal grid line.
+    double next_x = (dx != 0) ? ((cx + (dx > 0)) * 64 - x) / dx : INFINITY;
+    double next_y = (dy != 0) ? ((cy + (dy > 0)) * 64 - y) / dy : INFINITY;
+
+    const double delta_x = (dx != 0) ? 64 / std::abs(dx) : INFINITY;
+    const double delta_y = (dy != 0) ? 64 / std::abs(dy) : INFINITY;
+
+    while (true)
+    {
+        const double t = std::min(next_x, next_y);
+        if (t > max_distance) return {max_distance, -1};
+
+        if (next_x == next_y)
+        {
+            // Through a corner: only blocked when the cells on both sides of it are walls.
+            const int wall_x = wall_at(level, cx + step_x, cy);
+            const int wall_y = wall_at(level, cx, cy + step_y);
+            if (wall_x >= 0 && wall_y >= 0) return {t, wall_x};
+
+            cx += step_x;
+            cy += step_y;
+            next_x += delta_x;
+            next_y += delta_y;
+        }
+        else if (next_x < next_y)
+        {
+            cx += step_x;
+            next_x += delta_x;
+        }
+        else
+        {
+            cy += step_y;
+            next_y += delta_y;
+        }
+
+        const int wall = wall_at(level, cx, cy);
+        if (wall >= 0) return {t, wall};
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// SOUND PROPAGATION
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Reused between probes: a cell was reached by the current probe when its
+ * entry in seen equals generation, so nothing has to be cleared per probe.
+ */
+struct SoundScratch
+{
+    std::vector<uint32_t> seen;
+    std::vector<int> frontier;
+    std::vector<int> next;
+    uint32_t generation = 0;
+};
+
+static bool open_cell(const Level& level, int cx, int cy)
+{
+    return cx >= 0 && cx < level.width && cy >= 0 && cy < level.height &&
+           level[cy * level.width + cx] == 0;
+}
+
+// Breadth first through the open cells, a ring of cells per step, until the listener is reached.
+static double propagate(const Level& level, const SoundProbe& probe, SoundScratch& scratch)
+{
+    const int sx = std::floor(probe.x0 / 64), sy = std::floor(probe.y0 / 64);
+    const int lx = std::floor(probe.x1 / 64), ly = std::floor(probe.y1 / 64);
+
+    if (!open_cell(level, sx, sy) || !open_cell(level, lx, ly)) return INFINITY;
+    if (sx == lx && sy == ly) return 0;
+
+    const int cells = level.width * level.height;
+    if (scratch.seen.size() != static_cast<size_t>(cells) || ++scratch.generation == 0)
+    {
+        scratch.seen.assign(cells, 0);
+        scratch.generation = 1;
+    }
+
+    const int listener = ly * level.width + lx;
+    const int max_steps = probe.range / 64;
+
+    scratch.frontier.assign(1, sy * level.width + sx);
+    scratch.seen[scratch.frontier[0]] = scratch.generation;
+
+    for (int steps = 1; steps <= max_steps && !scratch.frontier.empty(); ++steps)
+    {
+        scratch.next.clear();
+
+        for (const int cell : scratch.frontier)
+        {
+            const int cx = cell % level.width;
+            const int cy = cell / level.width;
+
+            for (const auto& [ox, oy] : {std::pair{1, 0}, {-1, 0}, {0, 1}, {0, -1}})
+            {
+                if (!open_cell(level, cx + ox, cy + oy)) continue;
+
+                const int neighbour = cell + oy * level.width + ox;
+                if (neighbour == listener) return steps * 64.0;
+                if (scratch.seen[neighbour] == scratch.generation) continue;
+
+                scratch.seen[neighbour] = scratch.generation;
+                scratch.next.push_back(neighbour);
+            }
+        }
+
+        std::swap(scratch.frontier, scratch.next);
+    }
+
+    return INFINITY;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// QUERY FUNCTIONS
+///////////////////////////////////////////////////////////////////////////////
+
+bool line_of_sight(const Level& level, const Segment& segment)
+{
+    const double dx = segment.x1 - segment.x0;
+    const double dy = segment.y1 - segment.y0;
+    const double length = std::hypot(dx, dy);
+
+    if (length < EPSILON) return true;
+
+    return walk_grid(level, segment.x0, segment.y0, dx / length, dy / length, length).wall < 0;
+}
+
+TraceHit hitscan(const Level& level, const Trace& trace, std::span<const Target> targets)
+{
+    const double theta = degrees_to_radians(trace.angle);
+    const double dx = cos(theta);
+    const double dy = -sin(theta);
+
+    const GridHit wall = walk_grid(level, trace.x, trace.y, dx, dy, trace.range);
+
+    TraceHit hit;
+    hit.distance = wall.distance;
+    hit.wall = wall.wall;
+
+    // Only targets closer than the wall can be hit, the wall already bounds the search.
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        const double ex = targets[i].x - trace.x;
+        const double ey = targets[i].y - trace.y;
+
+        const double along = ex * dx + ey * dy;
+        const double across = ex * ex + ey * ey - along * along;
+        const double r2 = targets[i].radius * targets[i].radius;
+
+        if (along < 0 || across > r2) continue;
+
+        const double distance = std::max(0.0, along - std::sqrt(r2 - across));
+        if (distance < hit.distance)
+        {
+            hit.distance = distance;
+            hit.wall = -1;
+            hit.target = i;
+        }
+    }
+
+    hit.x = trace.x + hit.distance * dx;
+    hit.y = trace.y + hit.distance * dy;
+
+    return hit;
+}
+
+double sound_distance(const Level& level, const SoundProbe& probe)
+{
+    SoundScratch scratch;
+    return propagate(level, probe, scratch);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// BATCHED QUERIES
+///////////////////////////////////////////////////////////////////////////////
+
+// Calls answer(begin, end) for consecutive chunks of [0, count), spread over the pool.
+template <typename F>
+static void for_each_chunk(int count, ThreadPool& pool, F&& answer)
+{
+    const int chunks = (count + QUERY_CHUNK - 1) / QUERY_CHUNK;
+
+    pool.parallel_for(chunks,
+                      [&](int chunk)
+                      {
+                          const int begin = chunk * QUERY_CHUNK;
+                          answer(begin, std::min(count, begin + QUERY_CHUNK));
+                      });
+}
+
+void lines_of_sight(const Level& level, std::span<const Segment> segments,
+                    std::span<uint8_t> visible, ThreadPool& pool)
+{
+    const int count = std::min(segments.size(), visible.size());
+
+    for_each_chunk(count, pool,
+                   [&](int begin, int end)
+                   {
+                       for (int i = begin; i < end; ++i)
+                           visible[i] = line_of_sight(level, segments[i]);
+                   });
+}
+
+void hitscans(const Level& level, std::span<const Trace> traces, std::span<const Target> targets,
+              std::span<TraceHit> hits, ThreadPool& pool)
+{
+    const int count = std::min(traces.size(), hits.size());
+
+    for_each_chunk(count, pool,
+                   [&](int begin, int end)
+                   {
+                       for (int i = begin; i < end; ++i)
+                           hits[i] = hitscan(level, traces[i], targets);
+                   });
+}
+
+void sound_distances(const Level& level, std::span<const SoundProbe> probes,
+                     std::span<double> distances, ThreadPool& pool)
+{
+    const int count = std::min(probes.size(), distances.size());
+
+    for_each_chunk(count, pool,
+                   [&](int begin, int end)
+                   {
+                       SoundScratch scratch;
+                       for (int i = begin; i < end; ++i)
+                           distances[i] = propagate(level, probes[i], scratch);
+                   });
+}
+}  // namespace Engine
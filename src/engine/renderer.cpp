@@ -0,0 +1,357 @@
+#include "engine/renderer.h"
+
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+#include "engine/game.h"
+
+namespace Engine
+{
+/*
+ * Compiled scalers, in the spirit of the original Wolfenstein 3D: for every
+ * wall height, the texel row shown on each visible screen row. They are
+ * built with the same stepping the per-pixel loop used, so the result is
+ * identical, except that a row is never past the last texel row. Walls
+ * taller than the screen are clipped by starting at the first visible row,
+ * which turns drawing a column into a plain gather.
+ */
+class ColumnScalers
+{
+   public:
+    ColumnScalers()
+        : start(MAX_SCALED_HEIGHT + 2, 0)
+    {
+        for (int height = 1; height <= MAX_SCALED_HEIGHT; ++height)
+        {
+            start[height] = rows.size();
+            rows.resize(rows.size() + std::min(height, RENDER_HEIGHT));
+            build(height, rows.data() + start[height]);
+        }
+
+        start[MAX_SCALED_HEIGHT + 1] = rows.size();
+    }
+
+    // Writes the texel rows of the visible part of a wall, at most RENDER_HEIGHT of them.
+    static void build(int height, uint8_t* out)
+    {
+        const double ty_step = 64.0 / static_cast<double>(height);
+        double ty_offset = 0;
+
+        if (height > RENDER_HEIGHT)
+        {
+            ty_offset = (height - RENDER_HEIGHT) / 2;
+            height = RENDER_HEIGHT;
+        }
+
+        double ty = ty_offset * ty_step;
+        for (int y = 0; y < height; ++y)
+        {
+            out[y] = std::min(63, static_cast<int>(ty));
+            ty += ty_step;
+        }
+    }
+
+    const uint8_t* operator[](int height) const
+    {
+        return rows.data() + start[height];
+    }
+
+   private:
+    std::vector<uint8_t> rows;
+    std::vector<size_t> start;
+};
+
+static const ColumnScalers scalers;
+
+// Shown by cells whose texture isn't in the table, like a level loaded before its textures.
+static const Texture missing_texture = Texture::placeholder();
+
+void draw_wall_column(std::span<uint8_t> pixels, int ray, int wall_height, const uint8_t* texels)
+{
+    if (wall_height <= 0) return;
+
+    const uint8_t* rows;
+    uint8_t scratch[RENDER_HEIGHT];
+
+    // Only walls right in front of the camera are taller, they get their rows on the stack.
+    if (wall_height <= MAX_SCALED_HEIGHT)
+        rows = scalers[wall_height];
+    else
+    {
+        ColumnScalers::build(wall_height, scratch);
+        rows = scratch;
+    }
+
+    const int visible = std::min(wall_height, RENDER_HEIGHT);
+    const int offset = (RENDER_HEIGHT / 2) - (visible >> 1);
+
+    // Black texels are written as well, the buffer is cleared to black anyway.
+    uint8_t* pixel = pixels.data() + (offset * RENDER_WIDTH + ray) * 3;
+    for (int y = 0; y < visible; ++y, pixel += RENDER_WIDTH * 3)
+    {
+        const uint8_t* texel = texels + rows[y] * 3;
+        pixel[0] = texel[0];
+        pixel[1] = texel[1];
+        pixel[2] = texel[2];
+    }
+}
+
+/*
+ * Register vertical hits:
+ *  - First we calculate if the ray points to the left or right,
+ *    and we set the vertical ray and the offset multiplier accordingly.
+ *  - Then we search for the first wall that the vertical ray hits. The ray
+ *    crosses at most level.width vertical grid lines before leaving.
+ */
+double calculate_vertical_hits(const Level& level, double px, double py, double theta,
+                               double tangent, double& vx, double& vy, int& vmt)
+{
+    double d_vertical = INFINITY;
+    double ox, oy;
+
+    if (cos(theta) > EPSILON)  // Points left
+    {
+        vx = ((static_cast<int>(px) >> 6) << 6) + 64;
+        vy = (px - vx) * tangent + py;
+
+        ox = 64;
+        oy = -64 * tangent;
+    }
+    else if (cos(theta) < -EPSILON)  // Points right
+    {
+        vx = ((static_cast<int>(px) >> 6) << 6) - EPSILON;
+        vy = (px - vx) * tangent + py;
+
+        ox = -64;
+        oy = 64 * tangent;
+    }
+    else  // Points straight up or down, no hit
+    {
+        vx = px;
+        vy = py;
+
+        return d_vertical;
+    }
+
+    for (int depth = 0; depth <= level.width; ++depth)
+    {
+        // Calculate Position relative to the grid and see if there is a hit.
+        const int cx = static_cast<int>(vx) >> 6;
+        const int cy = static_cast<int>(vy) >> 6;
+        if (cx < 0 || cx >= level.width || cy < 0 || cy >= level.height) break;  // Left the level
+
+        int pos = cy * level.width + cx;
+        bool hit = pos > 0 && level[pos] > 0;
+        if (hit)
+        {
+            vmt = level[pos] - 1;
+            d_vertical = cos(theta) * (vx - px) - sin(theta) * (vy - py);
+
+            break;
+        }
+
+        vx += ox;
+        vy += oy;
+    }
+
+    return d_vertical;
+}
+
+/*
+ * Register horizontal hits:
+ *  - First we calculate if the ray points to the up or down,
+ *    and we set the horizontal ray and the offset multiplier accordingly.
+ *  - Then we search for the first wall that the horizontal ray hits. The ray
+ *    crosses at most level.height horizontal grid lines before leaving.
+ */
+double calculate_horizontal_hits(const Level& level, double px, double py, double theta,
+                                 double tangent, double& hx, double& hy, int& hmt)
+{
+    tangent = 1.0 / tangent;
+
+    double d_horizontal = INFINITY;
+    double ox, oy;
+
+    if (sin(theta) > EPSILON)  // Points up
+    {
+        hy = ((static_cast<int>(py) >> 6) << 6) - EPSILON;
+        hx = (py - hy) * tangent + px;
+
+        ox = 64 * tangent;
+        oy = -64;
+    }
+    else if (sin(theta) < -EPSILON)  // Points down
+    {
+        hy = ((static_cast<int>(py) >> 6) << 6) + 64;
+        hx = (py - hy) * tangent + px;
+
+        ox = -64 * tangent;
+        oy = 64;
+    }
+    else  // Points straight left or right, no hit
+    {
+        hx = px;
+        hy = py;
+
+        return d_horizontal;
+    }
+
+    for (int depth = 0; depth <= level.height; ++depth)
+    {
+        // Calculate Position relative to the grid and see if there is a hit.
+        const int cx = static_cast<int>(hx) >> 6;
+        const int cy = static_cast<int>(hy) >> 6;
+        if (cx < 0 || cx >= level.width || cy < 0 || cy >= level.height) break;  // Left the level
+
+        int pos = cy * level.width + cx;
+        bool hit = pos > 0 && level[pos] > 0;
+        if (hit)
+        {
+            hmt = level[pos] - 1;
+            d_horizontal = cos(theta) * (hx - px) - sin(theta) * (hy - py);
+
+            break;
+        }
+
+        hx += ox;
+        hy += oy;
+    }
+
+    return d_horizontal;
+}
+
+SpriteProjection project_sprite(const Camera& camera, double cos_theta, double sin_theta, double x,
+                                double y, double z)
+{
+    // Sprite position relative to the camera
+    const double rx = x - camera.x;
+    const double ry = y - camera.y;
+
+    // Transformation matrix to compute world space coordinates
+    const double a = cos_theta * ry + sin_theta * rx;
+    const double b = -sin_theta * ry + cos_theta * rx;
+
+    SpriteProjection projection;
+
+    // Transform world coordinates to screen space
+    projection.sx = (a * 108.0 / b) + (120 / 2);
+    projection.sy = (z * 108.0 / b) + (80 / 2);
+    projection.depth = b;
+
+    int scale = 32 * 80 / b;
+    scale = std::max(0, scale);
+    projection.scale = std::min(120, scale);
+
+    return projection;
+}
+
+void render_view(const Level& level, const TextureTable& textures, const Camera& camera,
+                 std::span<uint8_t> pixels, std::span<int> depth, const Lightmap* lightmap)
+{
+    int vmt = 0, hmt = 0;
+
+    double pa = camera.angle;
+    double r_angle = clamp_to_unit_circle(pa + 30);
+
+    // Vertical vector and horizontal vector representing a ray
+    double vx, vy;
+    double hx, hy;
+
+    // Reset pixel buffer
+    std::memset(pixels.data(), 0, RENDER_WIDTH * RENDER_HEIGHT * 3 * sizeof(uint8_t));
+
+    for (int ray = 0; ray < RENDER_WIDTH; ++ray)
+    {
+        double theta = degrees_to_radians(r_angle);
+        double tangent = tan(theta);
+
+        // These functions change the values of hx, hy, hmt, vx, vy, vmt.
+        double d_horizontal =
+            calculate_horizontal_hits(level, camera.x, camera.y, theta, tangent, hx, hy, hmt);
+        double d_vertical =
+            calculate_vertical_hits(level, camera.x, camera.y, theta, tangent, vx, vy, vmt);
+        double shade = 1;
+
+        /*
+         * We take the ray with the shortest distance to draw the scene.
+         * To create the illusion of shadows, we use a different color
+         * for vertical hits and horizontal hits.
+         */
+        if (d_vertical < d_horizontal)
+        {
+            hx = vx;
+            hy = vy;
+            d_horizontal = d_vertical;
+            hmt = vmt;
+        }
+        else
+            shade = 0.5;
+
+        // A ray leaving a level without walls at its edge hits nothing and hides no sprite.
+        if (!std::isfinite(d_horizontal))
+        {
+            depth[ray] = INT_MAX;
+            r_angle = clamp_to_unit_circle(r_angle - 60.0 / RENDER_WIDTH);
+            continue;
+        }
+
+        d_horizontal *= cos(degrees_to_radians(clamp_to_unit_circle(pa - r_angle)));
+        depth[ray] = d_horizontal;
+
+        int wall_height = (64 * RENDER_HEIGHT) / d_horizontal;
+        int tx;
+
+        if (shade == 1)
+        {
+            tx = static_cast<int>(hy) % 64;
+            if (camera.angle > 90 && camera.angle < 270) tx = 63 - tx;
+        }
+        else
+        {
+            tx = static_cast<int>(hx) % 64;
+            if (camera.angle > 180) tx = 63 - tx;
+        }
+
+        int light_level = FULL_BRIGHT;
+
+        // One lookup per column, the texture already holds a copy shaded to every level.
+        if (lightmap)
+        {
+            const int cx = static_cast<int>(hx) >> 6;
+            const int cy = static_cast<int>(hy) >> 6;
+
+            Face face;
+            if (shade == 1)
+                face = (r_angle < 90 || r_angle > 270) ? WEST : EAST;
+            else
+                face = (r_angle > 0 && r_angle < 180) ? SOUTH : NORTH;
+
+            if (cx >= 0 && cx < level.width && cy >= 0 && cy < level.height)
+                light_level = lightmap->light_level(cx, cy, face);
+        }
+
+        const bool known = hmt >= 0 && hmt < static_cast<int>(textures.size());
+        const Texture& texture = known ? *textures[hmt] : missing_texture;
+
+        const uint8_t* texels = texture.column(tx, light_level);
+        draw_wall_column(pixels, ray, wall_height, texels);
+
+        r_angle = clamp_to_unit_circle(r_angle - 60.0 / RENDER_WIDTH);
+    }
+}
+
+void render_views(const Level& level, const TextureTable& textures,
+                  std::span<const Camera> cameras, std::span<FrameBuffer> frames,
+                  ThreadPool& pool, const Lightmap* lightmap)
+{
+    const int count = std::min(cameras.size(), frames.size());
+
+    pool.parallel_for(count,
+                      [&](int i)
+                      {
+                          render_view(level, textures, cameras[i], frames[i].pixels,
+                                      frames[i].depth, lightmap);
+                      });
+}
+}  // namespace Engine
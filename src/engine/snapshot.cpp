@@ -0,0 +1,366 @@
+#include "engine/snapshot.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace Engine
+{
+///////////////////////////////////////////////////////////////////////////////
+// CONSTANTS AND DECLARATIONS
+///////////////////////////////////////////////////////////////////////////////
+
+const uint32_t SNAPSHOT_MAGIC = 0x53443357;  // "W3DS"
+const uint32_t SNAPSHOT_VERSION = 1;
+
+// Equal bytes shorter than this don't end a literal run, a new run would cost more.
+const size_t MIN_ZERO_RUN = 4;
+
+///////////////////////////////////////////////////////////////////////////////
+// ENCODING HELPERS
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+static void put(std::vector<uint8_t>& out, T value)
+{
+    const size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+template <typename T>
+static bool take(std::span<const uint8_t>& in, T& value)
+{
+    if (in.size() < sizeof(T)) return false;
+
+    std::memcpy(&value, in.data(), sizeof(T));
+    in = in.subspan(sizeof(T));
+
+    return true;
+}
+
+static void put_varint(std::vector<uint8_t>& out, size_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+
+    out.push_back(value);
+}
+
+static bool take_varint(std::span<const uint8_t>& in, size_t& value)
+{
+    value = 0;
+
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        uint8_t byte;
+        if (!take(in, byte)) return false;
+
+        value |= static_cast<size_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+
+    return false;
+}
+
+// Number of equal bytes in a and b starting at i, compared eight at a time.
+static size_t equal_run(const uint8_t* a, const uint8_t* b, size_t i, size_t n)
+{
+    const size_t start = i;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        uint64_t x, y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+
+        if (x != y) break;
+    }
+
+    while (i < n && a[i] == b[i]) i++;
+
+    return i - start;
+}
+
+/*
+ * Encodes current against base, both of the same size, as a list of
+ * (equal bytes, literal length, XOR of the literal bytes) triples.
+ */
+static std::vector<uint8_t> encode_delta(const std::vector<uint8_t>& base,
+                                         const std::vector<uint8_t>& current)
+{
+    std::vector<uint8_t> delta;
+    const size_t n = base.size();
+    size_t i = 0;
+
+    while (i < n)
+    {
+        const size_t zeros = equal_run(base.data(), current.data(), i, n);
+        i += zeros;
+
+        const size_t start = i;
+        while (i < n)
+        {
+            const size_t end = std::min(n, i + MIN_ZERO_RUN);
+            const size_t run = equal_run(base.data(), current.data(), i, end);
+            if (run == MIN_ZERO_RUN || i + run == n) break;
+
+            i += run + 1;
+        }
+
+        put_varint(delta, zeros);
+        put_varint(delta, i - start);
+        for (size_t j = start; j < i; ++j) delta.push_back(base[j] ^ current[j]);
+    }
+
+    return delta;
+}
+
+static bool decode_delta(const std::vector<uint8_t>& base, std::span<const uint8_t> delta,
+                         std::vector<uint8_t>& out)
+{
+    out = base;
+    size_t i = 0;
+
+    while (!delta.empty())
+    {
+        size_t zeros, literal;
+        if (!take_varint(delta, zeros) || !take_varint(delta, literal)) return false;
+
+        i += zeros;
+        if (i + literal > out.size() || literal > delta.size()) return false;
+
+        for (size_t j = 0; j < literal; ++j) out[i + j] ^= delta[j];
+
+        i += literal;
+        delta = delta.subspan(literal);
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// SNAPSHOTS
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<uint8_t> save_snapshot(const Game& game)
+{
+    std::vector<uint8_t> data;
+    data.reserve(64 + game.level.width * game.level.height * sizeof(int32_t) +
+                 game.enemies.size() * 3 * sizeof(double));
+
+    put(data, SNAPSHOT_MAGIC);
+    put(data, SNAPSHOT_VERSION);
+
+    put(data, game.player.x);
+    put(data, game.player.y);
+    put(data, game.player.angle);
+
+    put<int32_t>(data, game.level.width);
+    put<int32_t>(data, game.level.height);
+    for (int i = 0; i < game.level.width * game.level.height; ++i)
+        put<int32_t>(data, game.level[i]);
+
+    put<uint32_t>(data, game.enemies.size());
+    for (const auto& enemy : game.enemies)
+    {
+        put(data, enemy->x);
+        put(data, enemy->y);
+        put(data, enemy->z);
+    }
+
+    return data;
+}
+
+bool load_snapshot(Game& game, std::span<const uint8_t> data)
+{
+    uint32_t magic, version;
+    if (!take(data, magic) || !take(data, version)) return false;
+    if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION) return false;
+
+    double x, y, angle;
+    int32_t width, height;
+
+    if (!take(data, x) || !take(data, y) || !take(data, angle)) return false;
+    if (!take(data, width) || !take(data, height) || width < 0 || height < 0) return false;
+    if (data.size() / sizeof(int32_t) < static_cast<size_t>(width) * height) return false;
+
+    std::vector<int> cells(width * height);
+    for (int& cell : cells)
+    {
+        // Cells index the texture table, a bad save is held to the same check as Level::load.
+        int32_t value;
+        if (!take(data, value) || !Level::valid_cell(value)) return false;
+        cell = value;
+    }
+
+    uint32_t count;
+    if (!take(data, count) || data.size() != count * 3 * sizeof(double)) return false;
+
+    std::vector<std::unique_ptr<Enemy>> enemies;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        double ex, ey, ez;
+        if (!take(data, ex) || !take(data, ey) || !take(data, ez)) return false;
+
+        enemies.push_back(std::make_unique<Enemy>(ex, ey, ez));
+    }
+
+    game.player.x = x;
+    game.player.y = y;
+    game.player.angle = angle;
+
+    // Most snapshots, like every tick of a rewind, bring the cells the level already has.
+    bool changed = width != game.level.width || height != game.level.height;
+    for (int i = 0; i < width * height && !changed; ++i) changed = cells[i] != game.level[i];
+
+    // The static lights are not part of the state, they come with the level.
+    Level level{width, height, std::move(cells)};
+    level.lights = std::move(game.level.lights);
+    level.generation = game.level.generation + changed;
+
+    game.level = std::move(level);
+    game.enemies = std::move(enemies);
+
+    return true;
+}
+
+bool save_snapshot_file(const std::string& path, const Game& game)
+{
+    const std::vector<uint8_t> data = save_snapshot(game);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(reinterpret_cast<const char*>(data.data()), data.size()))
+    {
+        std::cout << "Problem saving " + path << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool load_snapshot_file(const std::string& path, Game& game)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> data{std::istreambuf_iterator<char>(file), {}};
+
+    if (!file.is_open() || !load_snapshot(game, data))
+    {
+        std::cout << "Problem loading " + path << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// REWIND BUFFER
+///////////////////////////////////////////////////////////////////////////////
+
+RewindBuffer::RewindBuffer(size_t _max_ticks, size_t _max_bytes, int _keyframe_interval)
+    : max_ticks(_max_ticks),
+      max_bytes(_max_bytes),
+      keyframe_interval(_keyframe_interval)
+{
+}
+
+void RewindBuffer::record(const Game& game)
+{
+    std::vector<uint8_t> snapshot = save_snapshot(game);
+
+    // Deltas need a keyframe of the same layout, otherwise a new keyframe starts.
+    const bool keyframe =
+        groups.empty() || groups.back().keyframe.size() != snapshot.size() ||
+        groups.back().deltas.size() + 1 >= static_cast<size_t>(keyframe_interval);
+
+    if (keyframe)
+    {
+        byte_count += snapshot.size();
+        groups.push_back({std::move(snapshot), {}});
+    }
+    else
+    {
+        std::vector<uint8_t> delta = encode_delta(groups.back().keyframe, snapshot);
+
+        byte_count += delta.size();
+        groups.back().deltas.push_back(std::move(delta));
+    }
+
+    tick_count++;
+    evict();
+}
+
+bool RewindBuffer::seek(Game& game, size_t ticks_ago) const
+{
+    if (ticks_ago >= tick_count) return false;
+
+    // Walk back from the newest group, most seeks are for recent ticks.
+    for (auto group = groups.rbegin(); group != groups.rend(); ++group)
+    {
+        const size_t size = group->deltas.size() + 1;
+
+        if (ticks_ago < size)
+        {
+            const size_t index = size - 1 - ticks_ago;
+            if (index == 0) return load_snapshot(game, group->keyframe);
+
+            std::vector<uint8_t> snapshot;
+            return decode_delta(group->keyframe, group->deltas[index - 1], snapshot) &&
+                   load_snapshot(game, snapshot);
+        }
+
+        ticks_ago -= size;
+    }
+
+    return false;
+}
+
+void RewindBuffer::truncate(size_t ticks_ago)
+{
+    for (; ticks_ago > 0 && !groups.empty(); --ticks_ago)
+    {
+        Group& group = groups.back();
+
+        if (group.deltas.empty())
+        {
+            byte_count -= group.keyframe.size();
+            groups.pop_back();
+        }
+        else
+        {
+            byte_count -= group.deltas.back().size();
+            group.deltas.pop_back();
+        }
+
+        tick_count--;
+    }
+}
+
+size_t RewindBuffer::ticks() const
+{
+    return tick_count;
+}
+
+size_t RewindBuffer::bytes() const
+{
+    return byte_count;
+}
+
+// Drops the oldest groups, but always keeps the one being recorded into.
+void RewindBuffer::evict()
+{
+    while ((tick_count > max_ticks || byte_count > max_bytes) && groups.size() > 1)
+    {
+        const Group& group = groups.front();
+
+        tick_count -= group.deltas.size() + 1;
+        byte_count -= group.keyframe.size();
+        for (const auto& delta : group.deltas) byte_count -= delta.size();
+
+        groups.pop_front();
+    }
+}
+}  // namespace Engine
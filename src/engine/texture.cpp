@@ -4,7 +4,25 @@ namespace Engine
 {
 Texture::Texture(std::string name)
 {
-    load(name);
+    if (!load(name)) exit(0);
+}
+
+Texture Texture::placeholder()
+{
+    Texture texture;
+    texture.data.resize(64 * 64);
+
+    for (int y = 0; y < 64; ++y)
+    {
+        for (int x = 0; x < 64; ++x)
+        {
+            texture.data[y * 64 + x] = ((x >> 3) + (y >> 3)) % 2 ? 0x404040 : 0x808080;
+        }
+    }
+
+    texture.build_columns();
+
+    return texture;
 }
 
 uint32_t Texture::operator[](int i) const
@@ -12,66 +30,73 @@ uint32_t Texture::operator[](int i) const
     return data[i];
 }
 
-uint32_t& Texture::operator[](int i)
+const uint8_t* Texture::column(int x, int light_level) const
 {
-    return data[i];
+    return columns.data() + (light_level * 64 + x) * 64 * 3;
+}
+
+// Shading up front means lighting a wall column costs the renderer nothing but this offset.
+void Texture::build_columns()
+{
+    columns.resize(LIGHT_LEVELS * 64 * 64 * 3);
+
+    for (int level = 0; level < LIGHT_LEVELS; ++level)
+    {
+        for (int x = 0; x < 64; ++x)
+        {
+            for (int y = 0; y < 64; ++y)
+            {
+                const uint32_t color = data[y * 64 + x];
+                uint8_t* texel = columns.data() + ((level * 64 + x) * 64 + y) * 3;
+
+                texel[0] = std::min<int>(255, (color >> 16) * level / FULL_BRIGHT);
+                texel[1] = std::min<int>(255, ((color >> 8) & 0xFF) * level / FULL_BRIGHT);
+                texel[2] = std::min<int>(255, (color & 0xFF) * level / FULL_BRIGHT);
+            }
+        }
+    }
 }
 
 /*
- * This statemachine loads PPM files.
+ * This function loads PPM files.
  * It ensures the following image properties:
  * - magic number P6
  * - 64 by 64 pixels
  * - colours expressed in unsigned bytes (255)
  *
- * In case of violation of these properties, the program
- * states the problem and exits.
+ * In case of violation of these properties, the problem
+ * is reported and false is returned.
  */
-void Texture::load(std::string name)
+bool Texture::load(std::string name)
 {
-    std::ifstream file("data/textures/" + name);
+    std::ifstream file("data/textures/" + name, std::ios::binary);
     std::string s;
-    int line = 0;
 
-    while (std::getline(file, s))  // clang-format off
+    for (const char* expected : {"P6", "64 64", "255"})
     {
-        switch (line)
+        if (!std::getline(file, s) || s != expected)
         {
-            case 0: if (s != "P6")    goto error; break;
-            case 1: if (s != "64 64") goto error; break;
-            case 2: if (s != "255")   goto error; break;
-            default: {
-                int state = 0;
-                uint32_t color = 0;
-
-                for (const uint8_t c : s) {
-                    switch (state)
-                    {
-                        case 0: color |= (c << 16); break;  // red
-                        case 1: color |= (c << 8); break;   // green
-                        case 2:                             // blue
-                        {
-                            color |= c;
-                            data.push_back(color);
-                            
-                            color = 0;
-                            state = -1;
-                            break;
-                        }
-                    }
-
-                    state++;
-                }
-                break;
-            }
-            error:
-            {
-                std::cout << "Problem loading " + name + ":" << s << std::endl;
-                exit(0);
-            }
+            std::cout << "Problem loading " + name + ":" << s << std::endl;
+            return false;
         }
+    }
+
+    // The pixels are binary and may contain newlines, so they are read at once.
+    uint8_t pixels[64 * 64 * 3];
+    if (!file.read(reinterpret_cast<char*>(pixels), sizeof(pixels)))
+    {
+        std::cout << "Problem loading " + name + ": truncated pixel data" << std::endl;
+        return false;
+    }
 
-        line++;
-    }  // clang-format on
-};
-}  // namespace Engine
\ No newline at end of file
+    data.resize(64 * 64);
+    for (int i = 0; i < 64 * 64; ++i)
+    {
+        data[i] = (pixels[i * 3] << 16) | (pixels[i * 3 + 1] << 8) | pixels[i * 3 + 2];
+    }
+
+    build_columns();
+
+    return true;
+}
+}  // namespace Engine
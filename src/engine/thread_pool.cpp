@@ -0,0 +1,99 @@
+#include "engine/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace Engine
+{
+ThreadPool::ThreadPool(unsigned int threads)
+{
+    // The calling thread also works during parallel_for, so spawn one less.
+    for (unsigned int i = 1; i < threads; ++i) workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+unsigned int ThreadPool::concurrency() const
+{
+    return workers.size() + 1;
+}
+
+void ThreadPool::parallel_for(int count, const std::function<void(int)>& task)
+{
+    std::atomic<int> next{0};
+    int pending = std::min<int>(workers.size(), count - 1);
+
+    std::mutex done_mutex;
+    std::condition_variable done;
+
+    auto run = [&]()
+    {
+        for (int i = next++; i < count; i = next++) task(i);
+    };
+
+    for (int helper = pending; helper > 0; --helper)
+    {
+        enqueue(
+            [&]()
+            {
+                run();
+
+                std::lock_guard<std::mutex> lock(done_mutex);
+                if (--pending == 0) done.notify_one();
+            });
+    }
+
+    run();
+
+    // The helpers reference this stack frame, so wait for all of them to leave.
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done.wait(lock, [&]() { return pending <= 0; });
+}
+
+void ThreadPool::submit(std::function<void()> job)
+{
+    if (workers.empty())
+        job();
+    else
+        enqueue(std::move(job));
+}
+
+void ThreadPool::enqueue(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(job));
+    }
+
+    wake.notify_one();
+}
+
+void ThreadPool::work()
+{
+    while (true)
+    {
+        std::function<void()> job;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !queue.empty(); });
+
+            if (stopping && queue.empty()) return;
+
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        job();
+    }
+}
+}  // namespace Engine
@@ -1,12 +1,237 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
 #include "engine/engine.h"
 
+/*
+ * Renders the requested number of frames in batches of views without
+ * opening a window, and reports the throughput. The cameras are spread
+ * over a circle around the center of the level, all looking inwards.
+ */
+void benchmark_views(int frames)
+{
+    Engine::ThreadPool pool;
+    const auto assets = Engine::asset_manager.current();
+    const Engine::Level& level = assets->level ? *assets->level : Engine::context.game.level;
+    const int batch = 16 * pool.concurrency();
+
+    std::vector<Engine::Camera> cameras(batch);
+    std::vector<Engine::FrameBuffer> buffers(batch);
+
+    // Lit like the window, so a view looks the same as the game's from that camera.
+    Engine::Lightmap lightmap;
+    lightmap.bake(level);
+
+    const double center_x = level.width * 32.0;
+    const double center_y = level.height * 32.0;
+
+    for (int i = 0; i < batch; ++i)
+    {
+        const double angle = 360.0 * i / batch;
+        const double theta = Engine::degrees_to_radians(angle);
+
+        cameras[i].x = center_x - 250 * cos(theta);
+        cameras[i].y = center_y + 250 * sin(theta);
+        cameras[i].angle = angle;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (int rendered = 0; rendered < frames; rendered += batch)
+    {
+        const int count = std::min(batch, frames - rendered);
+        Engine::render_views(level, assets->textures,
+                             std::span(cameras).first(count), buffers, pool, &lightmap);
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const double fps = frames / elapsed.count();
+
+    std::cout << frames << " frames in " << elapsed.count() << " s on " << pool.concurrency()
+              << " threads: " << fps << " frames/s, " << fps / pool.concurrency()
+              << " frames/s per core" << std::endl;
+}
+
+/*
+ * Runs independent game instances without a window, all sharing the loaded
+ * assets, and reports how many instance ticks (a step and a render each)
+ * per second the pool sustains. Every instance starts facing another way
+ * and walks while turning, so their worlds diverge.
+ */
+void benchmark_instances(int instances, int ticks)
+{
+    Engine::ThreadPool pool;
+    const auto assets = Engine::asset_manager.current();
+
+    std::vector<std::unique_ptr<Engine::EngineContext>> contexts;
+    for (int i = 0; i < instances; ++i)
+    {
+        auto context = std::make_unique<Engine::EngineContext>(assets);
+        context->game.player.angle = 360.0 * i / instances;
+        context->game.keys.w = true;
+        context->game.keys.a = i % 2 == 0;
+        context->game.keys.d = i % 2 == 1;
+        context->game.add_enemy<Engine::Skull>(250, 400, 15);
+
+        contexts.push_back(std::move(context));
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < ticks; ++tick) Engine::tick_contexts(contexts, 1000.0 / 60, pool);
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const double rate = static_cast<double>(instances) * ticks / elapsed.count();
+
+    std::cout << instances << " instances, " << ticks << " ticks in " << elapsed.count()
+              << " s on " << pool.concurrency() << " threads: " << rate << " instance ticks/s, "
+              << rate / pool.concurrency() << " per core" << std::endl;
+}
+
+/*
+ * Answers batches of line of sight checks, hitscan traces and sound probes
+ * between random points in the open cells of the level, as many per batch
+ * as queries, and reports how many of each the pool answers per second.
+ */
+void benchmark_queries(int queries, int ticks)
+{
+    Engine::ThreadPool pool;
+    const auto assets = Engine::asset_manager.current();
+    const Engine::Level& level = assets->level ? *assets->level : Engine::context.game.level;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> unit(0, 1);
+
+    auto random_point = [&](double& x, double& y)
+    {
+        do
+        {
+            x = unit(rng) * level.width * 64;
+            y = unit(rng) * level.height * 64;
+        } while (level[static_cast<int>(y / 64) * level.width + static_cast<int>(x / 64)] != 0);
+    };
+
+    std::vector<Engine::Segment> segments(queries);
+    std::vector<Engine::Trace> traces(queries);
+    std::vector<Engine::SoundProbe> probes(queries);
+    std::vector<Engine::Target> targets(16);
+
+    for (int i = 0; i < queries; ++i)
+    {
+        random_point(segments[i].x0, segments[i].y0);
+        random_point(segments[i].x1, segments[i].y1);
+
+        traces[i] = {segments[i].x0, segments[i].y0, unit(rng) * 360, 1024};
+        probes[i] = {segments[i].x0, segments[i].y0, segments[i].x1, segments[i].y1, 1024};
+    }
+
+    for (Engine::Target& target : targets)
+    {
+        random_point(target.x, target.y);
+        target.radius = 16;
+    }
+
+    std::vector<uint8_t> visible(queries);
+    std::vector<Engine::TraceHit> hits(queries);
+    std::vector<double> distances(queries);
+
+    auto measure = [&](const char* name, auto&& batch)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int tick = 0; tick < ticks; ++tick) batch();
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        const double rate = static_cast<double>(queries) * ticks / elapsed.count();
+
+        std::cout << name << ": " << rate << " queries/s, " << elapsed.count() / ticks * 1000
+                  << " ms per batch of " << queries << std::endl;
+    };
+
+    std::cout << pool.concurrency() << " threads" << std::endl;
+    measure("line of sight", [&]() { Engine::lines_of_sight(level, segments, visible, pool); });
+    measure("hitscan", [&]() { Engine::hitscans(level, traces, targets, hits, pool); });
+    measure("sound", [&]() { Engine::sound_distances(level, probes, distances, pool); });
+}
+
+Engine::FrameFormat parse_format(const char* name)
+{
+    if (std::strcmp(name, "ppm") == 0) return Engine::FrameFormat::PPM;
+    if (std::strcmp(name, "y4m") == 0) return Engine::FrameFormat::Y4M;
+
+    return Engine::FrameFormat::RAW;
+}
+
 int main(int argc, char* argv[])
 {
-    Engine::textures.push_back(Engine::Texture("wood.ppm"));
-    Engine::textures.push_back(Engine::Texture("eagle.ppm"));
+    Engine::asset_manager.load_level("e1m1.map");
+    Engine::asset_manager.load_texture("wood.ppm");
+    Engine::asset_manager.load_texture("eagle.ppm");
+
+    Engine::asset_manager.load_texture("skull.ppm");
+    Engine::context.game.add_enemy<Engine::Skull>(250, 400, 15);
+
+    // Five minutes of game time, whatever the frame rate.
+    Engine::context.enable_rewind(5 * 60 * Engine::REWIND_RATE, 64 << 20);
+
+    // Our own options are consumed here, everything else is passed on to GLUT.
+    std::vector<char*> glut_args{argv[0]};
+    const char* record_path = nullptr;
+    const char* record_format = nullptr;
+    int headless_frames = 0;
+    int instances = 0;
+    int queries = 0;
+    int ticks = 600;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--headless") == 0 && i + 1 < argc)
+            headless_frames = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--instances") == 0 && i + 1 < argc)
+            instances = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--queries") == 0 && i + 1 < argc)
+            queries = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+            ticks = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            record_path = argv[++i];
+        else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+            record_format = argv[++i];
+        else if (std::strcmp(argv[i], "--watch") == 0)
+        {
+            Engine::asset_watcher = Engine::AssetWatcher::start(Engine::asset_manager);
+            if (!Engine::asset_watcher)
+                std::cout << "Problem watching the data directory" << std::endl;
+        }
+        else
+            glut_args.push_back(argv[i]);
+    }
+
+    if (headless_frames > 0 || instances > 0 || queries > 0)
+    {
+        Engine::asset_manager.wait();
+
+        if (headless_frames > 0) benchmark_views(headless_frames);
+        if (instances > 0) benchmark_instances(instances, ticks);
+        if (queries > 0) benchmark_queries(queries, ticks);
+
+        return 0;
+    }
+
+    if (record_path)
+    {
+        Engine::FrameFormat format = Engine::FrameSink::format_from_path(record_path);
+        if (record_format) format = parse_format(record_format);
 
-    Engine::textures.push_back(Engine::Texture("skull.ppm"));
-    Engine::game.add_enemy<Engine::Skull>(250, 400, 15);
+        Engine::frame_sink = Engine::FrameSink::open(record_path, format, Engine::RENDER_WIDTH,
+                                                     Engine::RENDER_HEIGHT, Engine::RECORD_FPS);
+        if (!Engine::frame_sink)
+        {
+            std::cout << "Problem opening " << record_path << std::endl;
+            exit(0);
+        }
+    }
 
-    Engine::initialize(argc, argv);
-}
\ No newline at end of file
+    int glut_argc = glut_args.size();
+    Engine::initialize(glut_argc, glut_args.data());
+}